@@ -84,6 +84,7 @@
 #define MINI_INI_H_
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <algorithm>
 #include <utility>
@@ -104,6 +105,16 @@ namespace mINI
 			str.erase(str.find_last_not_of(whitespaceDelimiters) + 1);
 			str.erase(0, str.find_first_not_of(whitespaceDelimiters));
 		}
+		inline std::string_view trimmed(std::string_view str)
+		{
+			auto first = str.find_first_not_of(whitespaceDelimiters);
+			if (first == std::string_view::npos)
+			{
+				return std::string_view();
+			}
+			auto last = str.find_last_not_of(whitespaceDelimiters);
+			return str.substr(first, last - first + 1);
+		}
 #ifndef MINI_CASE_SENSITIVE
 		inline void toLower(std::string& str)
 		{
@@ -160,6 +171,18 @@ namespace mINI
 		{
 		}
 
+		// access by key that is already trimmed; key is normalized in place so a
+		// reused buffer can be passed and only newly inserted keys allocate
+		T& findOrInsert(std::string& key)
+		{
+#ifndef MINI_CASE_SENSITIVE
+			INIStringUtil::toLower(key);
+#endif
+			auto it = dataIndexMap.find(key);
+			bool hasIt = (it != dataIndexMap.end());
+			std::size_t index = (hasIt) ? it->second : setEmpty(key);
+			return data[index].second;
+		}
 		T& operator[](std::string key)
 		{
 			INIStringUtil::trim(key);
@@ -260,6 +283,7 @@ namespace mINI
 	namespace INIParser
 	{
 		using T_ParseValues = std::pair<std::string, std::string>;
+		using T_ParseViews = std::pair<std::string_view, std::string_view>;
 
 		enum class PDataType : char
 		{
@@ -270,11 +294,12 @@ namespace mINI
 			PDATA_UNKNOWN
 		};
 
-		inline PDataType parseLine(std::string line, T_ParseValues& parseData)
+		// zero-copy variant; views point into line, key escapes ("\\=") are left as they are
+		inline PDataType parseLine(std::string_view line, T_ParseViews& parseData)
 		{
-			parseData.first.clear();
-			parseData.second.clear();
-			INIStringUtil::trim(line);
+			parseData.first = std::string_view();
+			parseData.second = std::string_view();
+			line = INIStringUtil::trimmed(line);
 			if (line.empty())
 			{
 				return PDataType::PDATA_NONE;
@@ -287,35 +312,44 @@ namespace mINI
 			if (firstCharacter == '[')
 			{
 				auto commentAt = line.find_first_of(';');
-				if (commentAt != std::string::npos)
+				if (commentAt != std::string_view::npos)
 				{
 					line = line.substr(0, commentAt);
 				}
 				auto closingBracketAt = line.find_last_of(']');
-				if (closingBracketAt != std::string::npos)
+				if (closingBracketAt != std::string_view::npos)
 				{
-					auto section = line.substr(1, closingBracketAt - 1);
-					INIStringUtil::trim(section);
-					parseData.first = section;
+					parseData.first = INIStringUtil::trimmed(line.substr(1, closingBracketAt - 1));
 					return PDataType::PDATA_SECTION;
 				}
 			}
-			auto lineNorm = line;
-			INIStringUtil::replace(lineNorm, "\\=", "  ");
-			auto equalsAt = lineNorm.find_first_of('=');
-			if (equalsAt != std::string::npos)
-			{
-				auto key = line.substr(0, equalsAt);
-				INIStringUtil::trim(key);
-				INIStringUtil::replace(key, "\\=", "=");
-				auto value = line.substr(equalsAt + 1);
-				INIStringUtil::trim(value);
-				parseData.first = key;
-				parseData.second = value;
+			// first equals sign that isn't escaped
+			auto equalsAt = line.find_first_of('=');
+			while (equalsAt != std::string_view::npos && equalsAt > 0 && line[equalsAt - 1] == '\\')
+			{
+				equalsAt = line.find_first_of('=', equalsAt + 1);
+			}
+			if (equalsAt != std::string_view::npos)
+			{
+				parseData.first = INIStringUtil::trimmed(line.substr(0, equalsAt));
+				parseData.second = INIStringUtil::trimmed(line.substr(equalsAt + 1));
 				return PDataType::PDATA_KEYVALUE;
 			}
 			return PDataType::PDATA_UNKNOWN;
 		}
+
+		inline PDataType parseLine(std::string const& line, T_ParseValues& parseData)
+		{
+			T_ParseViews parseViews;
+			auto parseResult = parseLine(std::string_view(line), parseViews);
+			parseData.first.assign(parseViews.first);
+			parseData.second.assign(parseViews.second);
+			if (parseResult == PDataType::PDATA_KEYVALUE)
+			{
+				INIStringUtil::replace(parseData.first, "\\=", "=");
+			}
+			return parseResult;
+		}
 	}
 
 	class INIReader
@@ -330,54 +364,19 @@ namespace mINI
 		std::ifstream fileReadStream;
 		T_LineDataPtr lineData;
 
-		T_LineData readFile()
+		std::string readFile()
 		{
 			fileReadStream.seekg(0, std::ios::end);
 			const std::size_t fileSize = static_cast<std::size_t>(fileReadStream.tellg());
 			fileReadStream.seekg(0, std::ios::beg);
-			if (fileSize >= 3) {
-				const char header[3] = {
-					static_cast<char>(fileReadStream.get()),
-					static_cast<char>(fileReadStream.get()),
-					static_cast<char>(fileReadStream.get())
-				};
-				isBOM = (
-					header[0] == static_cast<char>(0xEF) &&
-					header[1] == static_cast<char>(0xBB) &&
-					header[2] == static_cast<char>(0xBF)
-				);
-			}
-			else {
-				isBOM = false;
-			}
 			std::string fileContents;
 			fileContents.resize(fileSize);
-			fileReadStream.seekg(isBOM ? 3 : 0, std::ios::beg);
-			fileReadStream.read(&fileContents[0], fileSize);
-			fileReadStream.close();
-			T_LineData output;
-			if (fileSize == 0)
+			if (fileSize > 0)
 			{
-				return output;
+				fileReadStream.read(&fileContents[0], fileSize);
 			}
-			std::string buffer;
-			buffer.reserve(50);
-			for (std::size_t i = 0; i < fileSize; ++i)
-			{
-				char& c = fileContents[i];
-				if (c == '\n')
-				{
-					output.emplace_back(buffer);
-					buffer.clear();
-					continue;
-				}
-				if (c != '\0' && c != '\r')
-				{
-					buffer += c;
-				}
-			}
-			output.emplace_back(buffer);
-			return output;
+			fileReadStream.close();
+			return fileContents;
 		}
 
 	public:
@@ -389,43 +388,105 @@ namespace mINI
 				lineData = std::make_shared<T_LineData>();
 			}
 		}
+		// tag selecting reader for contents that are already in memory (see parse())
+		struct T_InMemory { };
+		static constexpr T_InMemory inMemory{};
+
+		INIReader(T_InMemory, bool keepLineData = false)
+		{
+			if (keepLineData)
+			{
+				lineData = std::make_shared<T_LineData>();
+			}
+		}
 		~INIReader() { }
 
-		bool operator>>(INIStructure& data)
+		// parse whole file contents (for example memory mapped file)
+		// lines are tokenized in place, only sections, keys and values that
+		// are stored in data are allocated
+		bool parse(std::string_view contents, INIStructure& data)
 		{
-			if (!fileReadStream.is_open())
+			if (contents.empty())
 			{
-				return false;
+				return true;
 			}
-			T_LineData fileLines = readFile();
-			std::string section;
-			bool inSection = false;
-			INIParser::T_ParseValues parseData;
-			for (auto const& line : fileLines)
+			isBOM = (
+				contents.size() >= 3 &&
+				contents[0] == static_cast<char>(0xEF) &&
+				contents[1] == static_cast<char>(0xBB) &&
+				contents[2] == static_cast<char>(0xBF)
+			);
+			if (isBOM)
+			{
+				contents.remove_prefix(3);
+			}
+			INIMap<std::string>* sectionData = nullptr;
+			INIParser::T_ParseViews parseData;
+			std::string keyBuffer, lineBuffer;
+			std::size_t lineStart = 0;
+			for (;;)
 			{
+				auto lineEnd = contents.find('\n', lineStart);
+				auto line = contents.substr(lineStart, (lineEnd == std::string_view::npos) ? std::string_view::npos : lineEnd - lineStart);
+				// carriage returns and null characters are dropped from the line,
+				// copy is needed only if they are somewhere else than at its end
+				auto strayAt = line.find_first_of(std::string_view("\r\0", 2));
+				if (strayAt != std::string_view::npos && strayAt != line.size() - 1)
+				{
+					lineBuffer.clear();
+					for (char c : line)
+					{
+						if (c != '\0' && c != '\r')
+						{
+							lineBuffer += c;
+						}
+					}
+					line = lineBuffer;
+				}
+				else if (strayAt != std::string_view::npos)
+				{
+					line.remove_suffix(1);
+				}
 				auto parseResult = INIParser::parseLine(line, parseData);
 				if (parseResult == INIParser::PDataType::PDATA_SECTION)
 				{
-					inSection = true;
-					data[section = parseData.first];
+					keyBuffer.assign(parseData.first);
+					sectionData = &data.findOrInsert(keyBuffer);
 				}
-				else if (inSection && parseResult == INIParser::PDataType::PDATA_KEYVALUE)
+				else if (sectionData && parseResult == INIParser::PDataType::PDATA_KEYVALUE)
 				{
-					auto const& key = parseData.first;
-					auto const& value = parseData.second;
-					data[section][key] = value;
+					keyBuffer.assign(parseData.first);
+					if (parseData.first.find("\\=") != std::string_view::npos)
+					{
+						INIStringUtil::replace(keyBuffer, "\\=", "=");
+					}
+					sectionData->findOrInsert(keyBuffer).assign(parseData.second);
 				}
 				if (lineData && parseResult != INIParser::PDataType::PDATA_UNKNOWN)
 				{
-					if (parseResult == INIParser::PDataType::PDATA_KEYVALUE && !inSection)
+					if (!(parseResult == INIParser::PDataType::PDATA_KEYVALUE && !sectionData))
 					{
-						continue;
+						lineData->emplace_back(line);
 					}
-					lineData->emplace_back(line);
 				}
+				if (lineEnd == std::string_view::npos)
+				{
+					break;
+				}
+				lineStart = lineEnd + 1;
 			}
 			return true;
 		}
+
+		bool operator>>(INIStructure& data)
+		{
+			if (!fileReadStream.is_open())
+			{
+				return false;
+			}
+			std::string fileContents = readFile();
+			return parse(fileContents, data);
+		}
 		T_LineDataPtr getLines()
 		{
 			return lineData;
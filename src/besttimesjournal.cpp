@@ -0,0 +1,138 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "besttimesjournal.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32)
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+struct BestTimesJournalEntry
+{
+	uint32_t mode;
+	uint32_t time;
+	char name[BestTimesJournal::NAME_SIZE];
+	uint32_t checksum; //FNV-1a of all previous members
+};
+
+static uint32_t getChecksum(const BestTimesJournalEntry& entry)
+{
+	const unsigned char* bytes = (const unsigned char*)&entry;
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < offsetof(BestTimesJournalEntry, checksum); i++)
+	{
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+BestTimesJournal::BestTimesJournal() : entryCount(0)
+{
+}
+
+void BestTimesJournal::open(const std::string& path, const std::function<void(int mode, int time, const std::string& name)>& apply)
+{
+	this->path = path;
+	entryCount = 0;
+
+	FILE* file = fopen(path.c_str(), "rb");
+
+	if (file == NULL)
+	{
+		return;
+	}
+
+	BestTimesJournalEntry entry;
+
+	while (fread(&entry, sizeof(entry), 1, file) == 1 && entry.checksum == getChecksum(entry))
+	{
+		entry.name[NAME_SIZE - 1] = '\0';
+		apply((int)entry.mode, (int)entry.time, entry.name);
+		entryCount++;
+	}
+
+	fclose(file);
+
+	//Cut off anything after last valid entry, so new entries aren't appended after garbage
+	std::error_code errorCode;
+	std::filesystem::resize_file(path, entryCount * sizeof(BestTimesJournalEntry), errorCode);
+}
+
+bool BestTimesJournal::append(int mode, int time, const std::string& name)
+{
+	if (path.empty())
+	{
+		return false;
+	}
+
+	BestTimesJournalEntry entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.mode = mode;
+	entry.time = time;
+	strncpy(entry.name, name.c_str(), NAME_SIZE - 1);
+	entry.checksum = getChecksum(entry);
+
+	FILE* file = fopen(path.c_str(), "ab");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool written = fwrite(&entry, sizeof(entry), 1, file) == 1 && fflush(file) == 0;
+
+	//Make sure entry reaches the disk, not just system cache
+#if defined(WIN32) || defined(_WIN32)
+	written = written && _commit(_fileno(file)) == 0;
+#else
+	written = written && fsync(fileno(file)) == 0;
+#endif
+
+	written = (fclose(file) == 0) && written;
+
+	if (written)
+	{
+		entryCount++;
+	}
+
+	return written;
+}
+
+bool BestTimesJournal::clear()
+{
+	if (path.empty())
+	{
+		return false;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::remove(path, errorCode);
+
+	if (!errorCode)
+	{
+		entryCount = 0;
+	}
+
+	return !errorCode;
+}
@@ -0,0 +1,45 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+//Journal of best time changes appended right when they happen
+//Each entry is one small write synced to disk and protected by checksum, so record set just before crash isn't lost
+//Journal is folded into besttimes.ini (compacted) on launch and exit, after which it's cleared
+class BestTimesJournal
+{
+public:
+	static const int NAME_SIZE = 16;
+
+	BestTimesJournal();
+
+	//Read all valid entries and pass them to apply in order they were written
+	//Torn or corrupted entry at the end (interrupted write) is dropped together with everything after it
+	void open(const std::string& path, const std::function<void(int mode, int time, const std::string& name)>& apply);
+
+	bool append(int mode, int time, const std::string& name);
+
+	//Remove journal after its entries were stored in config file
+	bool clear();
+
+	int getEntryCount() const { return entryCount; }
+
+private:
+	std::string path;
+	int entryCount;
+};
@@ -0,0 +1,126 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "blockarena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+	#include <sys/mman.h>
+#endif
+
+BlockArena::BlockArena(size_t blockSize) : blockSize(std::max(blockSize, sizeof(FreeBlock))), nextSlabSize(ARENA_FIRST_SLAB_SIZE), freeBlocks(NULL)
+{
+}
+
+BlockArena::~BlockArena()
+{
+	for (const auto& slab : slabs)
+	{
+		std::free(slab.first);
+	}
+}
+
+void* BlockArena::allocate()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (freeBlocks == NULL)
+	{
+		addSlab();
+	}
+
+	FreeBlock* block = freeBlocks;
+	freeBlocks = block->next;
+
+	return block;
+}
+
+void BlockArena::release(void* block)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	FreeBlock* freeBlock = (FreeBlock*)block;
+	freeBlock->next = freeBlocks;
+	freeBlocks = freeBlock;
+}
+
+size_t BlockArena::getReservedSize() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	size_t size = 0;
+
+	for (const auto& slab : slabs)
+	{
+		size += slab.second;
+	}
+
+	return size;
+}
+
+//Blocks of new slab are linked in address order, so following allocations go through memory sequentially
+void BlockArena::addSlab()
+{
+	size_t slabSize = std::max(nextSlabSize, blockSize);
+	nextSlabSize = std::min(nextSlabSize * 2, (size_t)ARENA_HUGE_PAGE_SIZE);
+
+	void* slab = NULL;
+
+#if defined(_WIN32) || defined(WIN32)
+	slab = std::malloc(slabSize);
+#else
+	if (posix_memalign(&slab, (slabSize >= ARENA_HUGE_PAGE_SIZE) ? ARENA_HUGE_PAGE_SIZE : 4096, slabSize) != 0)
+	{
+		slab = NULL;
+	}
+#endif
+
+	if (slab == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	adviseHugePages(slab, slabSize);
+	slabs.emplace_back(slab, slabSize);
+
+	unsigned char* blocks = (unsigned char*)slab;
+	size_t blockCount = slabSize / blockSize;
+
+	for (size_t i = blockCount; i > 0; i--)
+	{
+		FreeBlock* block = (FreeBlock*)(blocks + (i - 1) * blockSize);
+		block->next = freeBlocks;
+		freeBlocks = block;
+	}
+}
+
+void adviseHugePages(void* data, size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	uintptr_t begin = ((uintptr_t)data + ARENA_HUGE_PAGE_SIZE - 1) / ARENA_HUGE_PAGE_SIZE * ARENA_HUGE_PAGE_SIZE;
+	uintptr_t end = ((uintptr_t)data + size) / ARENA_HUGE_PAGE_SIZE * ARENA_HUGE_PAGE_SIZE;
+
+	if (begin < end)
+	{
+		madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+	}
+#else
+	(void)data;
+	(void)size;
+#endif
+}
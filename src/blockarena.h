@@ -0,0 +1,61 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#define ARENA_FIRST_SLAB_SIZE (64 * 1024) //Slabs double from this size, so small fields don't reserve much memory
+#define ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024) //Largest slab, it's aligned to huge page and can be backed by one
+
+//Allocator of fixed size blocks carved from slabs that are kept until arena is destroyed
+//Released blocks are reused by next allocations, so new game of the same or smaller size doesn't allocate at all
+//On Linux big slabs are marked for transparent huge pages, which cuts TLB misses when whole field is scanned
+//Blocks can be allocated and released from multiple threads
+class BlockArena
+{
+public:
+	explicit BlockArena(size_t blockSize);
+	~BlockArena();
+
+	BlockArena(const BlockArena&) = delete;
+	BlockArena& operator=(const BlockArena&) = delete;
+
+	void* allocate();
+	void release(void* block);
+
+	size_t getBlockSize() const { return blockSize; }
+
+	//Memory taken from the system (in bytes)
+	size_t getReservedSize() const;
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	void addSlab();
+
+	size_t blockSize;
+	size_t nextSlabSize;
+	std::vector<std::pair<void*, size_t>> slabs;
+	FreeBlock* freeBlocks;
+	mutable std::mutex mutex;
+};
+
+//Ask for transparent huge pages in the part of memory that covers whole huge pages (Linux only, it does nothing elsewhere)
+void adviseHugePages(void* data, size_t size);
@@ -15,20 +15,41 @@ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 #include <SDL.h>
 
 #include <iostream>
-#include <random>
 #include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <future>
+#include <deque>
 
 #include "SDL_render.h"
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_sdlrenderer2.h"
 
+#include "threadpool.h"
+#include "latencyhistogram.h"
+#include "startupprofiler.h"
+#include "fontatlascache.h"
+#include "gamehistory.h"
+#include "besttimesjournal.h"
+#include "leaderboard.h"
+#include "mappedfile.h"
+#include "random.h"
+#include "replay.h"
+#include "minefield.h"
+#include "endlessfield.h"
+#include "savedgame.h"
+#include "minimap.h"
+
 #include "mini/ini.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
 
+#include "embeddedassets.h"
+
 #define GAME_VERSION "2.1"
 
 #define TILE_SIZE 16
@@ -36,29 +57,69 @@ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 #define DISPLAY_WIDTH 13
 #define DISPLAY_HEIGHT 23
 
+#define MAX_ZOOM 4.0f
+#define MIN_TILE_PIXELS 2.0f //Smallest size of tile on the screen when zooming out
+#define PIXEL_TILE_PIXELS 4.0f //Smaller tiles are drawn as single pixels of field texture instead of sprites
+#define ASYNC_GENERATE_TILES (1 << 20) //Fields with at least that many tiles are generated on worker thread
+#define FIELD_BAND_ROWS 32 //Rows of tiles processed by one job when building field vertices
+#define PARALLEL_TILE_COUNT 16384 //Build field vertices on worker threads only if at least that many tiles are visible
+#define LOW_LATENCY_IDLE_TIMEOUT 16 //Time (in ms) to wait for input before drawing frame anyway in low latency mode
+#define UNDO_LIMIT 1000 //Moves that can be reverted
+#define ENDLESS_CHUNK_BUDGET 1024 //Chunks of endless field kept in memory (about 4 MB)
+#define MINIMAP_SIZE 128 //Largest side of minimap (in pixels at content scale 1)
+#define MINIMAP_MARGIN 4 //Distance between minimap and border of field view
+
 #if !SDL_VERSION_ATLEAST(2,0,17)
 #error This backend requires SDL 2.0.17+ because of SDL_RenderGeometry() function
 #endif
 
 #if defined(WIN32) || defined(_WIN32)
 	#define PATH_SEPARATOR "\\"
+	#include <fcntl.h>
+	#include <io.h>
 #else
 	#define PATH_SEPARATOR "/"
+	#include <fcntl.h>
+	#include <unistd.h>
 #endif
 
 enum FaceState { NORMAL, NORMAL_CLICK, FIELD_CLICK, GAME_WON, GAME_LOST };
-enum GameMode { BEGINNER, ADVANCED, EXPERT, CUSTOM };
-enum WindowType { CUSTOM_GAME, BEST_SCORES, ABOUT, NEW_TIME };
+enum GameMode { BEGINNER, ADVANCED, EXPERT, CUSTOM, ENDLESS };
+enum WindowType { CUSTOM_GAME, BEST_SCORES, ABOUT, NEW_TIME, INPUT_LATENCY, STATISTICS };
 enum GameState { INITIALIZED, STARTED, WON, LOST };
 
-struct FieldType
+//Sprite table index bit set when game is lost (field state is in lower byte)
+#define SPRITE_GAME_LOST 0x100
+
+//Lookup table mapping field state and game lost flag to tile sprite row
+struct FieldSpriteTable
+{
+	Uint8 rows[512];
+};
+
+//Vertices of visible part of the field with view and field state they were built for
+struct FieldGeometry
+{
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+	int tileCount;
+	unsigned revision;
+	bool gameLost;
+	float viewX, viewY, viewZoom;
+	SDL_Rect viewRect;
+	bool valid;
+};
+
+//Texture with one pixel per tile for far zoomed out view, pixels are kept to refresh only changed rows
+struct FieldPixels
 {
-	bool isVisible; //Field visible
-	bool isMine; //Field with mine
-	bool isFlag; //Field with flag
-	bool isUnknown; //Unknown field
-	bool isClicked; //Field that user clicks (draw pushed button instead of normal)
-	int mineCount; //Mine count around field (should be 0 if field is mine or with no mines around)
+	SDL_Texture* texture;
+	int textureWidth, textureHeight;
+	std::vector<Uint32> pixels; //Copy of texture, row after row of textureWidth pixels
+	int firstRow, firstColumn, rows, columns;
+	unsigned revision;
+	bool gameLost, endless;
+	bool valid;
 };
 
 struct BestTimes
@@ -67,28 +128,110 @@ struct BestTimes
 	int bestTime;
 };
 
-struct StbImage
+//Image with RGBA pixels, embedded in binary or loaded from --assets directory
+struct RgbaImage
 {
-    unsigned char* pixels;
-    int width;
-    int height;
-    int channels;
+	const unsigned char* pixels;
+	int width;
+	int height;
+	bool loaded; //Pixels were loaded by stb_image and have to be freed
 };
 
 GameMode gameMode = GameMode::BEGINNER;
 GameState gameState = GameState::INITIALIZED;
 bool marksEnabled = true;
-FieldType **fieldArray = NULL;
+Minefield minefield;
+EndlessField endlessField;
+std::string endlessStorePath; //File for chunks of endless field that don't fit in memory
+Minimap minimap;
+
+int fieldWidth, fieldHeight, fieldMines, windowWidth, windowHeight, gameTime, contentScale, clickCount;
+Uint64 gameSeed = 0; //Seed of current field, together with first click it fully determines mine positions
+bool gameSeedUsed = true; //Field was generated with current seed, next game needs new one
+bool practiceGame = false; //Move was reverted, so game doesn't count to history and best times
+int explodedRow = -1, explodedColumn = -1; //Tile that lost the game, it stays clicked until game ends or move is reverted
+Random seedGenerator; //Generates seeds of following games
+
+//Field view - big fields don't fit in the window so only part of them is drawn
+float viewZoom = 1.0f; //1 means tile is drawn with TILE_SIZE * contentScale pixels
+float viewX = 0.0f, viewY = 0.0f; //Field position (in screen pixels at current zoom) visible in top left corner of field view
+
+FieldGeometry fieldGeometry = {};
+FieldPixels fieldPixels = {};
+Uint32 spriteColours[256] = {}; //Average colour of every tile sprite (ARGB)
+
+//Big field is generated on worker thread, it isn't touched until generation is done
+//Meanwhile it's drawn hidden with clicked tile that is waiting for the field
+std::future<void> fieldGeneration;
+int pendingRow = -1, pendingColumn = -1;
+unsigned pendingRevision = 0;
+
+//History record of finished game waits until its 3BV is computed, records are appended in order games ended
+struct PendingGameRecord
+{
+	GameRecord record;
+	std::future<int> bv; //Not valid if 3BV is already in record
+};
+
+std::deque<PendingGameRecord> pendingGameRecords;
+ThreadPool* threadPool = NULL;
+StartupProfiler startupProfiler; //Created before main so time spent there is also measured
+
+//Get tile sprite row for field state
+//Rules are checked in the same order as they were when tiles were selected while drawing
+constexpr Uint8 getFieldSprite(int field, bool gameLost)
+{
+	bool isVisible = field & FIELD_VISIBLE;
+	bool isMine = (field & FIELD_COUNT_MASK) == FIELD_MINE;
+	bool isFlag = field & FIELD_FLAG;
+	bool isUnknown = field & FIELD_UNKNOWN;
+	bool isClicked = field & FIELD_CLICKED;
+	int mineCount = isMine ? 0 : (field & FIELD_COUNT_MASK);
+
+	if (!isVisible && isClicked) //Clicked hidden tile without mark
+		return 1;
 
-int fieldWidth, fieldHeight, fieldMines, windowWidth, windowHeight, gameTime, flagCount, contentScale;
-std::mt19937 randomEngine;
+	if (isVisible && !isMine && mineCount == 0) //Visible empty tile (same as pushed tile)
+		return 1;
 
-//Get random value in range
-int getRandomNumber(int min, int max)
+	if (isFlag && (!gameLost || isMine)) //Tile with flag (visible on all tiles if game is running or on tiles with mines if game ended)
+		return 2;
+
+	if (!isVisible && isUnknown && !isClicked) //Hidden tile with question mark
+		return 3;
+
+	if (!isVisible && isUnknown && isClicked) //Clicked hidden tile with question mark
+		return 4;
+
+	if (isVisible && mineCount > 0) //Visible tile with number (counts above 8 are never stored)
+		return mineCount <= 8 ? 4 + mineCount : 0;
+
+	if (isVisible && isMine && isClicked) //Visible tile with clicked mine
+		return 15;
+
+	if (isVisible && isMine) //Visible tile with mine
+		return 13;
+
+	if (!isMine && isFlag) //Tile with wrong flag (visible after game over instead of normal tile)
+		return 14;
+
+	return 0; //Hidden tile without mark and not clicked
+}
+
+constexpr FieldSpriteTable makeFieldSpriteTable()
 {
-	return std::uniform_int_distribution<int>{min, max}(randomEngine);
+	FieldSpriteTable table = {};
+
+	for (int i = 0; i < 512; i++)
+	{
+		table.rows[i] = getFieldSprite(i & 0xFF, i & SPRITE_GAME_LOST);
+	}
+
+	return table;
 }
 
+constexpr FieldSpriteTable fieldSpriteTable = makeFieldSpriteTable();
+
 //Draw display textures with provided values (get width to put right display in right border of the window)
 void drawDisplay(SDL_Renderer* renderer, SDL_Texture* displayTexture, int time, int flags, int width)
 {
@@ -141,7 +284,7 @@ void drawDisplay(SDL_Renderer* renderer, SDL_Texture* displayTexture, int time,
 	}
 
 	//Flags display conversion and drawing
-	valueStr = std::to_string(flagCount);
+	valueStr = std::to_string(flags);
 
 	if (flags >= 0)
 	{
@@ -158,7 +301,7 @@ void drawDisplay(SDL_Renderer* renderer, SDL_Texture* displayTexture, int time,
 	}
 	else if (flags < 0 && flags > -10)
 	{
-		valueStr = std::to_string(flagCount * (-1)); //Change flag count to positive number and convert again
+		valueStr = std::to_string(flags * (-1)); //Change flag count to positive number and convert again
 		valueStr = "-0" + valueStr;
 	}
 
@@ -205,422 +348,1116 @@ void drawFace(SDL_Renderer* renderer, SDL_Texture* faceTexture, FaceState state)
 	dstRect.h = FACE_SIZE * contentScale;
 	dstRect.y = (20 * contentScale);
 
-	//Window with is 16 (field tile width) * field width + 10 (5px margin on each side)
 	//Point (0, 0) is top left corner so substract half of the width to make it centered
-	dstRect.x = ((TILE_SIZE * contentScale) * fieldWidth + (10 * contentScale)) / 2 - ((srcRect.w * contentScale) / 2);
+	dstRect.x = (windowWidth * contentScale) / 2 - ((srcRect.w * contentScale) / 2);
 
 	SDL_RenderCopy(renderer, faceTexture, &srcRect, &dstRect);
 }
 
-//Draw mine field
-void drawField(SDL_Renderer* renderer, SDL_Texture* fieldTexture)
+//Get rectangle of the window (in pixels) used to show field
+SDL_Rect getFieldViewRect()
 {
-	SDL_Rect srcRect, dstRect;
+	SDL_Rect rect;
 
-	srcRect.w = TILE_SIZE;
-	srcRect.h = TILE_SIZE;
-	srcRect.x = 0;
+	rect.x = 5 * contentScale;
+	rect.y = 50 * contentScale;
+	rect.w = (windowWidth - 10) * contentScale;
+	rect.h = (windowHeight - 55) * contentScale;
 
-	dstRect.w = TILE_SIZE * contentScale;
-	dstRect.h = TILE_SIZE * contentScale;
+	return rect;
+}
 
-	for (int row = 0; row < fieldHeight; row++)
-	{
-		for (int col = 0; col < fieldWidth; col++)
-		{
-			if (!fieldArray[row][col].isVisible && fieldArray[row][col].isClicked) //Clicked hidden tile without mark
-			{
-				srcRect.y = 1 * TILE_SIZE;
-			}
-			else if (fieldArray[row][col].isVisible && !fieldArray[row][col].isMine && fieldArray[row][col].mineCount == 0) //Visible empty tile (same as pushed tile)
-			{
-				srcRect.y = 1 * TILE_SIZE;
-			}
-			else if (fieldArray[row][col].isFlag //Tile with flag (visible on all tiles if game is running or on tiles with mines if game ended)
-					&& (gameState != GameState::LOST || (gameState == GameState::LOST && fieldArray[row][col].isMine)))
-			{
-					srcRect.y = 2 * TILE_SIZE;
-			}
-			else if (!fieldArray[row][col].isVisible && fieldArray[row][col].isUnknown && !fieldArray[row][col].isClicked) //Hidden tile with question mark
-			{
-				srcRect.y = 3 * TILE_SIZE;
-			}
-			else if (!fieldArray[row][col].isVisible && fieldArray[row][col].isUnknown && fieldArray[row][col].isClicked) //Clicked hidden tile with question amrk
-			{
-				srcRect.y = 4 * TILE_SIZE;
-			}
-			else if (fieldArray[row][col].isVisible && fieldArray[row][col].mineCount > 0) //Visible tile with number
-			{
-				srcRect.y = (4 + fieldArray[row][col].mineCount) * TILE_SIZE;
-			}
-			else if (fieldArray[row][col].isVisible && fieldArray[row][col].isMine && fieldArray[row][col].isClicked) //Visible tile with clicked
-			{
-				srcRect.y = 15 * TILE_SIZE;
-			}
-			else if (fieldArray[row][col].isVisible && fieldArray[row][col].isMine) //Visible tile with mine
-			{
-				srcRect.y = 13 * TILE_SIZE;
-			}
-			else if (!fieldArray[row][col].isMine && fieldArray[row][col].isFlag) //Tile with wrong flag (visible after game over instead of normal tile)
-			{
-				srcRect.y = 14 * TILE_SIZE;
-			}
-			else if (!fieldArray[row][col].isVisible && !fieldArray[row][col].isClicked) //Hidden tile without mark and not clicked
-			{
-				srcRect.y = 0;
-			}
+//Get size of tile on the screen
+float getTileScreenSize()
+{
+	return TILE_SIZE * contentScale * viewZoom;
+}
 
-			dstRect.x = (5 * contentScale) + col * (TILE_SIZE * contentScale);
-			dstRect.y = (50 * contentScale) + row * (TILE_SIZE * contentScale);
+//Get smallest zoom - enough to see whole field but without tiles becoming smaller than MIN_TILE_PIXELS
+float getMinZoom()
+{
+	SDL_Rect viewRect = getFieldViewRect();
 
-			SDL_RenderCopy(renderer, fieldTexture, &srcRect, &dstRect);
-		}
+	if (gameMode == GameMode::ENDLESS)
+	{
+		return std::min(MIN_TILE_PIXELS / (TILE_SIZE * contentScale), 1.0f);
 	}
+
+	float fitZoom = std::min((float)viewRect.w / (fieldWidth * TILE_SIZE * contentScale), (float)viewRect.h / (fieldHeight * TILE_SIZE * contentScale));
+	float minZoom = std::max(fitZoom, MIN_TILE_PIXELS / (TILE_SIZE * contentScale));
+
+	return std::min(minZoom, 1.0f);
 }
 
-//Prepare new game with selected mode
-void prepareGame(int customWidth = 0, int customHeight = 0, int customMines = 0)
+//Keep field view inside the field, center field if it's smaller than view
+void clampView()
 {
-	int oldHeight = fieldHeight; //Save old height to use it in array deletion
-
-	switch (gameMode) //Predefined game modes
+	//Endless field has no borders
+	if (gameMode == GameMode::ENDLESS)
 	{
-		case GameMode::BEGINNER:
-			fieldWidth = 9;
-			fieldHeight = 9;
-			fieldMines = 10;
-		break;
+		return;
+	}
 
-		case GameMode::ADVANCED:
-			fieldWidth = 16;
-			fieldHeight = 16;
-			fieldMines = 40;
-		break;
+	SDL_Rect viewRect = getFieldViewRect();
+	float fieldPixelWidth = fieldWidth * getTileScreenSize();
+	float fieldPixelHeight = fieldHeight * getTileScreenSize();
 
-		case GameMode::EXPERT:
-			fieldWidth = 30;
-			fieldHeight = 16;
-			fieldMines = 99;
-		break;
+	if (fieldPixelWidth <= viewRect.w)
+	{
+		viewX = -(viewRect.w - fieldPixelWidth) / 2;
+	}
+	else
+	{
+		viewX = std::clamp(viewX, 0.0f, fieldPixelWidth - viewRect.w);
+	}
 
-		case GameMode::CUSTOM:
-			fieldWidth = customWidth;
-			fieldHeight = customHeight;
-			fieldMines = customMines;
-		break;
+	if (fieldPixelHeight <= viewRect.h)
+	{
+		viewY = -(viewRect.h - fieldPixelHeight) / 2;
 	}
+	else
+	{
+		viewY = std::clamp(viewY, 0.0f, fieldPixelHeight - viewRect.h);
+	}
+}
 
-	//Check if custom values are valid
-	if (gameMode == GameMode::CUSTOM)
+//Paged field reads tiles one view ahead in direction of movement, so they are in memory when view gets there
+void prefetchView(float moveX, float moveY)
+{
+	if (gameMode == GameMode::ENDLESS || !minefield.isPaged())
 	{
-		if (fieldWidth < 9)
-			fieldWidth = 9;
+		return;
+	}
 
-		if (fieldHeight < 9)
-			fieldHeight = 9;
+	SDL_Rect viewRect = getFieldViewRect();
+	float tileSize = getTileScreenSize();
 
-		if (fieldWidth > 100)
-			fieldWidth = 100;
+	int columns = (int)std::ceil(viewRect.w / tileSize) + 1;
+	int rows = (int)std::ceil(viewRect.h / tileSize) + 1;
+	int firstColumn = (int)std::floor(viewX / tileSize) + ((moveX > 0) ? columns : (moveX < 0) ? -columns : 0);
+	int firstRow = (int)std::floor(viewY / tileSize) + ((moveY > 0) ? rows : (moveY < 0) ? -rows : 0);
 
-		if (fieldHeight > 100)
-			fieldHeight = 100;
+	minefield.prefetchArea(firstRow, firstRow + rows, firstColumn, firstColumn + columns);
+}
 
-		if (fieldMines < 10)
-			fieldMines = 10;
+//Move field view by given amount of pixels
+void panView(float x, float y)
+{
+	viewX += x;
+	viewY += y;
 
-		if (fieldMines > (fieldWidth*fieldHeight) / 2) //At least half of fields should be empty
-			fieldMines = (fieldWidth*fieldHeight) / 2;
-	}
+	clampView();
+	prefetchView(x, y);
+}
 
-	flagCount = fieldMines;
+//Zoom field view, field point under (x, y) window position stays in place
+void zoomView(float factor, int x, int y)
+{
+	SDL_Rect viewRect = getFieldViewRect();
+	float newZoom = std::clamp(viewZoom * factor, getMinZoom(), MAX_ZOOM);
 
-	//If array was created before delete it
-	if (fieldArray != NULL)
-	{
-		for (int row = 0; row < oldHeight; row++)
-		{
-			delete [] fieldArray[row];
-		}
+	float fieldX = (x - viewRect.x + viewX) / viewZoom;
+	float fieldY = (y - viewRect.y + viewY) / viewZoom;
 
-		delete [] fieldArray;
-	}
+	viewZoom = newZoom;
+	viewX = fieldX * viewZoom - (x - viewRect.x);
+	viewY = fieldY * viewZoom - (y - viewRect.y);
 
-	//Create new array
-	fieldArray = new FieldType*[fieldHeight];
+	clampView();
+}
 
-	for (int i = 0; i < fieldHeight; i++)
-	{
-		fieldArray[i] = new FieldType[fieldWidth];
-	}
+//Reset field view to default zoom and top left corner of the field
+void resetView()
+{
+	viewZoom = 1.0f;
+	viewX = 0.0f;
+	viewY = 0.0f;
+
+	clampView();
+}
 
-	//Init created array
-	//Initaly all fields will be empty and hidden
-	for (int row = 0; row < fieldHeight; row++)
+//Resize window to fit current field
+void fitWindowToField(SDL_Window* window)
+{
+	//Window width is supposed to be field tile width * field width + 10 (5px margin on each side)
+	//Window hight is same but top margin should be bigger to make room for display and face
+	windowWidth = TILE_SIZE * fieldWidth + 10;
+	windowHeight = TILE_SIZE * fieldHeight + 10 + 45;
+
+	//Field that doesn't fit on the screen is shown partially, window is limited to 90% of display size
+	SDL_Rect displayBounds;
+
+	if (SDL_GetDisplayUsableBounds(SDL_GetWindowDisplayIndex(window), &displayBounds) == 0)
 	{
-		for (int col = 0; col < fieldWidth; col++)
-		{
-			fieldArray[row][col].isVisible = false;
-			fieldArray[row][col].isMine = false;
-			fieldArray[row][col].isFlag = false;
-			fieldArray[row][col].isUnknown = false;
-			fieldArray[row][col].isClicked = false;
-			fieldArray[row][col].mineCount = 0;
-		}
+		windowWidth = std::min(windowWidth, std::max(154, displayBounds.w * 9 / 10 / contentScale));
+		windowHeight = std::min(windowHeight, std::max(199, displayBounds.h * 9 / 10 / contentScale));
 	}
+
+	SDL_SetWindowSize(window, windowWidth * contentScale, windowHeight * contentScale);
 }
 
-//Check if field is mine
-bool isMine(int row, int column)
+//Minimap is shown only when field doesn't fit in field view (endless field has no borders to show)
+bool isMinimapVisible()
 {
-	if (row < 0 || row > fieldHeight - 1 || column < 0 || column > fieldWidth - 1) //Index out of bonds
+	if (gameMode == GameMode::ENDLESS)
 	{
 		return false;
 	}
 
-	return fieldArray[row][column].isMine;
+	SDL_Rect viewRect = getFieldViewRect();
+
+	return fieldWidth * getTileScreenSize() > viewRect.w || fieldHeight * getTileScreenSize() > viewRect.h;
 }
 
-//Generate new minefield (generates after first click so get position to prevent generating mine on this field)
-void generateField(int selectedRow, int selectedColumn)
+//Minimap is in bottom right corner of field view, it takes at most quarter of the view
+SDL_Rect getMinimapRect()
 {
-	//Setup mines
-	int mineRow = getRandomNumber(0, fieldHeight - 1);
-	int mineColumn = getRandomNumber(0, fieldWidth - 1);
+	SDL_Rect viewRect = getFieldViewRect();
+	SDL_Rect rect = {};
 
-	for (int i = 0; i < fieldMines; i++)
+	if (minimap.getWidth() == 0 || minimap.getHeight() == 0)
 	{
-		//Keep getting random number as long we dont get empty tile
-		//Also don't set mine on selected field
-		while ((mineRow == selectedRow && mineColumn == selectedColumn) || fieldArray[mineRow][mineColumn].isMine)
-		{
-			mineRow = getRandomNumber(0, fieldHeight - 1);
-			mineColumn = getRandomNumber(0, fieldWidth - 1);
-		}
-
-		//Set mine on selected field
-		fieldArray[mineRow][mineColumn].isMine = true;
+		return rect;
 	}
 
-	//Setup mine count
-	for (int row = 0; row < fieldHeight; row++)
-	{
-		for (int col = 0; col < fieldWidth; col++)
-		{
-			if (fieldArray[row][col].isMine) //Ignore fields with mine
-			{
-				continue;
-			}
-
-			int mineCount = 0;
-
-			if (isMine(row - 1, col - 1)) //Top left
-			{
-				mineCount++;
-			}
+	int size = std::min(MINIMAP_SIZE * contentScale, std::min(viewRect.w, viewRect.h) / 2);
+	float scale = (float)size / std::max(minimap.getWidth(), minimap.getHeight());
 
-			if (isMine(row - 1, col)) //Top
-			{
-				mineCount++;
-			}
+	rect.w = std::max(1, (int)(minimap.getWidth() * scale));
+	rect.h = std::max(1, (int)(minimap.getHeight() * scale));
+	rect.x = viewRect.x + viewRect.w - rect.w - MINIMAP_MARGIN * contentScale;
+	rect.y = viewRect.y + viewRect.h - rect.h - MINIMAP_MARGIN * contentScale;
 
-			if (isMine(row - 1, col + 1)) //Top right
-			{
-				mineCount++;
-			}
+	return rect;
+}
 
-			if (isMine(row, col - 1)) //Left
-			{
-				mineCount++;
-			}
+//Minimap pixels per screen pixel of the field
+float getMinimapScale()
+{
+	return (float)getMinimapRect().w / (minimap.getWidth() * minimap.getBlockSize() * getTileScreenSize());
+}
 
-			if (isMine(row, col + 1)) //Right
-			{
-				mineCount++;
-			}
+//Check if window position is on the minimap
+bool isOnMinimap(int x, int y)
+{
+	SDL_Rect rect = getMinimapRect();
+	SDL_Point point = { x, y };
 
-			if (isMine(row + 1, col - 1)) //Bottom left
-			{
-				mineCount++;
-			}
+	return isMinimapVisible() && SDL_PointInRect(&point, &rect);
+}
 
-			if (isMine(row + 1, col)) //Bottom
-			{
-				mineCount++;
-			}
+//Center field view on field position under minimap point
+void moveViewToMinimap(int x, int y)
+{
+	SDL_Rect viewRect = getFieldViewRect();
+	SDL_Rect rect = getMinimapRect();
+	float scale = getMinimapScale();
 
-			if (isMine(row + 1, col + 1)) //Bottom right
-			{
-				mineCount++;
-			}
+	viewX = (x - rect.x) / scale - viewRect.w / 2.0f;
+	viewY = (y - rect.y) / scale - viewRect.h / 2.0f;
 
-			fieldArray[row][col].mineCount = mineCount;
-		}
-	}
+	clampView();
 }
 
-//Recursively uncover all neighbourg empty tiles
-void floodFill(int row, int column)
+//Get tile under window position, returns false if there is no tile there
+bool getTileAt(int x, int y, int* row, int* column)
 {
-	if (row < 0 || row > fieldHeight - 1 || column < 0 || column > fieldWidth - 1) //Index out of bonds
+	SDL_Rect viewRect = getFieldViewRect();
+
+	//Minimap covers the field
+	if (isOnMinimap(x, y))
 	{
-		return;
+		return false;
 	}
 
-	//Skip tiles that are not hidden, with mine or with flag
-	if (fieldArray[row][column].isVisible || fieldArray[row][column].isMine || fieldArray[row][column].isFlag)
+	if (x < viewRect.x || y < viewRect.y || x >= viewRect.x + viewRect.w || y >= viewRect.y + viewRect.h)
 	{
-		return;
+		return false;
 	}
 
-	fieldArray[row][column].isVisible = true;
+	int tileColumn = (int)std::floor((x - viewRect.x + viewX) / getTileScreenSize());
+	int tileRow = (int)std::floor((y - viewRect.y + viewY) / getTileScreenSize());
 
-	//If field is count then return after making it visible
-	if (fieldArray[row][column].mineCount > 0)
+	if (gameMode != GameMode::ENDLESS && (tileRow < 0 || tileRow >= fieldHeight || tileColumn < 0 || tileColumn >= fieldWidth))
 	{
-		return;
+		return false;
 	}
 
-	floodFill(row - 1, column - 1); //Top left
-	floodFill(row - 1, column); //Top
-	floodFill(row - 1, column + 1); //Top right
-	floodFill(row, column - 1); //Left
-	floodFill(row, column + 1); //Right
-	floodFill(row + 1, column - 1); //Bottom left
-	floodFill(row + 1, column); //Bottom
-	floodFill(row + 1, column + 1); //Bottom right
+	*row = tileRow;
+	*column = tileColumn;
+
+	return true;
 }
 
-//Uncover selected tile
-//Also set game state if player won or lost
-void uncoverTile(int row, int column)
+//Check if window position is on the face
+bool isOnFace(int x, int y)
 {
-	if (fieldArray[row][column].isMine) //Clicked on field with mine so game over
-	{
-		gameState = GameState::LOST;
-		return;
-	}
+	return y >= (20 * contentScale) && y <= (20 * contentScale) + (FACE_SIZE * contentScale) &&
+		x >= (windowWidth * contentScale) / 2 - (FACE_SIZE * contentScale) / 2 &&
+		x <= (windowWidth * contentScale) / 2 + (FACE_SIZE * contentScale) / 2;
+}
+
+bool isGeneratingField()
+{
+	return fieldGeneration.valid();
+}
 
-	floodFill(row, column);
+//Start generating field with first click, click is applied in main loop when field is ready
+void startFieldGeneration(int row, int column)
+{
+	pendingRow = row;
+	pendingColumn = column;
+	pendingRevision = minefield.getRevision();
 
-	//Check if player won game (only mine tiles are left)
-	//All safe tiles should be visible
-	//Count visible tiles and check if their number is equal to number of tiles minus number of mines
-	int fieldCount = 0;
+	Uint64 seed = gameSeed;
+	auto generation = [seed, row, column]() { minefield.generate(seed, row, column, threadPool); };
 
-	for (int r = 0; r < fieldHeight; r++)
+	//Pool without workers would run generation right here, so it gets its own thread
+	if (threadPool->getThreadCount() == 0)
 	{
-		for (int c = 0; c < fieldWidth; c++)
-		{
-			if (fieldArray[r][c].isVisible)
-			{
-				fieldCount++;
-			}
-		}
+		fieldGeneration = std::async(std::launch::async, generation);
 	}
-
-	if (fieldCount == fieldWidth * fieldHeight - fieldMines)
+	else
 	{
-		gameState = GameState::WON;
+		fieldGeneration = threadPool->submit(generation);
 	}
 }
 
-//Expose field after game over
-void exposeField()
+//Tile access working with both regular and endless field
+FieldType getFieldTile(int row, int column)
 {
-	for (int row = 0; row < fieldHeight; row++)
+	if (isGeneratingField())
 	{
-		for (int col = 0; col < fieldWidth; col++)
-		{
-			if (fieldArray[row][col].isMine)
-			{
-				fieldArray[row][col].isVisible = true;
-			}
-		}
+		return (row == pendingRow && column == pendingColumn) ? FIELD_CLICKED : 0;
 	}
+
+	return (gameMode == GameMode::ENDLESS) ? endlessField.getTile(row, column) : minefield.getTile(row, column);
 }
 
-//Set flag or question mark (if enabled and already flag) on the field
-void markTile(int row, int column)
+//Copy states of count tiles starting at (row, column), can be called from worker threads
+void getFieldRow(int row, int column, int count, FieldType* tiles)
 {
-	//Can't mark visible fields
-	if (fieldArray[row][column].isVisible)
+	if (isGeneratingField())
 	{
+		for (int i = 0; i < count; i++)
+		{
+			tiles[i] = getFieldTile(row, column + i);
+		}
+
 		return;
 	}
 
-	if (fieldArray[row][column].isUnknown)
+	if (gameMode == GameMode::ENDLESS)
 	{
-		fieldArray[row][column].isUnknown = false;
+		endlessField.getRow(row, column, count, tiles);
 		return;
 	}
 
-	if (!fieldArray[row][column].isFlag)
+	for (int i = 0; i < count; i++)
 	{
-		fieldArray[row][column].isFlag = true;
-		flagCount--;
-		return;
+		tiles[i] = minefield.getTile(row, column + i);
 	}
+}
+
+bool isTileSelectable(int row, int column)
+{
+	return (gameMode == GameMode::ENDLESS) ? endlessField.isSelectable(row, column) : minefield.isSelectable(row, column);
+}
 
-	if (fieldArray[row][column].isFlag)
+void setTileClicked(int row, int column, bool clicked)
+{
+	if (gameMode == GameMode::ENDLESS)
+	{
+		endlessField.setClicked(row, column, clicked);
+	}
+	else
 	{
-		fieldArray[row][column].isFlag = false;
-		flagCount++;
+		minefield.setClicked(row, column, clicked);
+	}
+}
 
-		if (marksEnabled)
-		{
-			fieldArray[row][column].isUnknown = true;
-		}
+void markTile(int row, int column)
+{
+	if (gameMode == GameMode::ENDLESS)
+	{
+		endlessField.mark(row, column, marksEnabled);
+	}
+	else
+	{
+		minefield.mark(row, column, marksEnabled);
+	}
+}
 
-		return;
+void exposeField()
+{
+	if (gameMode == GameMode::ENDLESS)
+	{
+		endlessField.expose();
+	}
+	else
+	{
+		minefield.expose();
 	}
 }
 
-//Check if selected tile is selectable
-bool isSelectable(int row, int column)
+unsigned getFieldRevision()
 {
-	//Can't select fields that are visible or with flag
-	if (fieldArray[row][column].isVisible || fieldArray[row][column].isFlag)
+	if (isGeneratingField())
 	{
-		return false;
+		return pendingRevision;
 	}
 
-	return true;
+	return (gameMode == GameMode::ENDLESS) ? endlessField.getRevision() : minefield.getRevision();
 }
 
-//Create SDL_Surface from image loaded by stb_image
-SDL_Surface* surfaceFromStbImage(StbImage image)
+//Range of tiles that are at least partially visible in the view
+void getVisibleTiles(const SDL_Rect& viewRect, int& firstRow, int& firstColumn, int& lastRow, int& lastColumn)
 {
-    int pitch = image.width * image.channels;
-
-    Uint32 redMask, greenMask, blueMask, alphaMask;
-
-    #if SDL_BYTEORDER == SDL_BIG_ENDIAN
-        int shift = (image.channels == 4) ? 0 : 8;
-        redMask = 0xff000000 >> shift;
-        greenMask = 0x00ff0000 >> shift;
-        blueMask = 0x0000ff00 >> shift;
-        alphaMask = 0x000000ff >> shift;
-    #else
-        redMask = 0x000000ff;
-        greenMask = 0x0000ff00;
-        blueMask = 0x00ff0000;
-        alphaMask = (image.channels == 4) ? 0xff000000 : 0;
-    #endif
-
-    return SDL_CreateRGBSurfaceFrom(image.pixels, image.width, image.height, image.channels*8, pitch, redMask, greenMask, blueMask, alphaMask);
+	float tileSize = getTileScreenSize();
+
+	firstColumn = (int)std::floor(viewX / tileSize);
+	firstRow = (int)std::floor(viewY / tileSize);
+	lastColumn = (int)std::ceil((viewX + viewRect.w) / tileSize);
+	lastRow = (int)std::ceil((viewY + viewRect.h) / tileSize);
+
+	//Chunks of endless field are loaded here, worker threads only read them
+	if (gameMode == GameMode::ENDLESS)
+	{
+		endlessField.prepareArea(firstRow, firstColumn, lastRow, lastColumn);
+	}
+	else
+	{
+		firstColumn = std::max(0, firstColumn);
+		firstRow = std::max(0, firstRow);
+		lastColumn = std::min(fieldWidth, lastColumn);
+		lastRow = std::min(fieldHeight, lastRow);
+	}
 }
 
-int main(int argc, char* argv[])
+//Average colour of every sprite in tiles image, used for tiles drawn as single pixels
+void computeSpriteColours(const RgbaImage& image)
 {
-	SDL_Window* window = NULL;
-	SDL_Renderer* renderer = NULL;
-	SDL_Texture* fields = NULL, *faces = NULL, *display = NULL;
-	std::string basePath, prefPath;
+	int spriteCount = std::min(256, image.height / TILE_SIZE);
 
-	contentScale = 1;
+	for (int sprite = 0; sprite < spriteCount; sprite++)
+	{
+		int sum[3] = { 0, 0, 0 };
 
-	//Check if config directory is present and load it, try to create it otherwise
-	bool loadConfig = true;
+		for (int y = sprite * TILE_SIZE; y < (sprite + 1) * TILE_SIZE; y++)
+		{
+			for (int x = 0; x < std::min(TILE_SIZE, image.width); x++)
+			{
+				const unsigned char* pixel = image.pixels + ((size_t)y * image.width + x) * 4;
+
+				sum[0] += pixel[0];
+				sum[1] += pixel[1];
+				sum[2] += pixel[2];
+			}
+		}
+
+		int pixelCount = TILE_SIZE * std::min(TILE_SIZE, image.width);
+		spriteColours[sprite] = 0xFF000000u | ((sum[0] / pixelCount) << 16) | ((sum[1] / pixelCount) << 8) | (sum[2] / pixelCount);
+	}
+}
+
+//Draw far zoomed out field as texture with one pixel per tile, sprites would be too small to see anyway
+//Texture covers visible tiles, it's filled again when the view moves, otherwise only rows of changed chunks are refreshed
+void drawFieldPixels(SDL_Renderer* renderer)
+{
+	SDL_Rect viewRect = getFieldViewRect();
+	bool gameLost = (gameState == GameState::LOST);
+	bool endless = (gameMode == GameMode::ENDLESS);
+
+	int firstRow, firstColumn, lastRow, lastColumn;
+	getVisibleTiles(viewRect, firstRow, firstColumn, lastRow, lastColumn);
+
+	int columns = lastColumn - firstColumn;
+	int rows = lastRow - firstRow;
+
+	if (columns <= 0 || rows <= 0)
+	{
+		return;
+	}
+
+	//Texture only grows, smaller view uses its top left part
+	if (fieldPixels.texture == NULL || fieldPixels.textureWidth < columns || fieldPixels.textureHeight < rows)
+	{
+		if (fieldPixels.texture != NULL)
+		{
+			SDL_DestroyTexture(fieldPixels.texture);
+		}
+
+		fieldPixels.textureWidth = std::max(fieldPixels.textureWidth, columns);
+		fieldPixels.textureHeight = std::max(fieldPixels.textureHeight, rows);
+		fieldPixels.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, fieldPixels.textureWidth, fieldPixels.textureHeight);
+		fieldPixels.pixels.resize((size_t)fieldPixels.textureWidth * fieldPixels.textureHeight);
+		fieldPixels.valid = false;
+
+		if (fieldPixels.texture == NULL)
+		{
+			return;
+		}
+	}
+
+	unsigned revision = getFieldRevision();
+	int dirtyFirst = rows, dirtyLast = 0;
+
+	if (!fieldPixels.valid || fieldPixels.firstRow != firstRow || fieldPixels.firstColumn != firstColumn || fieldPixels.rows != rows || fieldPixels.columns != columns
+		|| fieldPixels.gameLost != gameLost || fieldPixels.endless != endless || (endless && fieldPixels.revision != revision))
+	{
+		dirtyFirst = 0;
+		dirtyLast = rows;
+	}
+	else if (fieldPixels.revision != revision)
+	{
+		//Chunks changed since the last refresh have the same or higher revision
+		for (int chunkRow = firstRow >> CHUNK_SHIFT; chunkRow <= (lastRow - 1) >> CHUNK_SHIFT; chunkRow++)
+		{
+			for (int chunkColumn = firstColumn >> CHUNK_SHIFT; chunkColumn <= (lastColumn - 1) >> CHUNK_SHIFT; chunkColumn++)
+			{
+				if (minefield.getChunkRevision((size_t)chunkRow * minefield.getChunkColumns() + chunkColumn) >= fieldPixels.revision)
+				{
+					dirtyFirst = std::min(dirtyFirst, std::max(0, chunkRow * CHUNK_SIZE - firstRow));
+					dirtyLast = std::max(dirtyLast, std::min(rows, (chunkRow + 1) * CHUNK_SIZE - firstRow));
+					break;
+				}
+			}
+		}
+	}
+
+	if (dirtyFirst < dirtyLast)
+	{
+		int lostBit = gameLost ? SPRITE_GAME_LOST : 0;
+		Uint32* pixels = fieldPixels.pixels.data();
+		int pitch = fieldPixels.textureWidth;
+
+		auto fillBand = [=](int band)
+		{
+			thread_local std::vector<Uint8> rowTiles;
+			rowTiles.resize(columns);
+
+			int bandEnd = std::min(dirtyLast, dirtyFirst + (band + 1) * FIELD_BAND_ROWS);
+
+			for (int i = dirtyFirst + band * FIELD_BAND_ROWS; i < bandEnd; i++)
+			{
+				getFieldRow(firstRow + i, firstColumn, columns, rowTiles.data());
+
+				Uint32* rowPixels = pixels + (size_t)i * pitch;
+
+				for (int col = 0; col < columns; col++)
+				{
+					rowPixels[col] = spriteColours[fieldSpriteTable.rows[rowTiles[col] | lostBit]];
+				}
+			}
+		};
+
+		int bandCount = (dirtyLast - dirtyFirst + FIELD_BAND_ROWS - 1) / FIELD_BAND_ROWS;
+
+		if ((dirtyLast - dirtyFirst) * columns >= PARALLEL_TILE_COUNT && threadPool != NULL)
+		{
+			threadPool->parallelFor(bandCount, fillBand);
+		}
+		else
+		{
+			for (int band = 0; band < bandCount; band++)
+			{
+				fillBand(band);
+			}
+		}
+
+		//Locked texture is write only, so rows are copied from kept pixels
+		SDL_Rect dirtyRect = { 0, dirtyFirst, columns, dirtyLast - dirtyFirst };
+		void* data;
+		int dataPitch;
+
+		if (SDL_LockTexture(fieldPixels.texture, &dirtyRect, &data, &dataPitch) == 0)
+		{
+			for (int i = 0; i < dirtyRect.h; i++)
+			{
+				memcpy((Uint8*)data + (size_t)i * dataPitch, pixels + (size_t)(dirtyFirst + i) * pitch, columns * sizeof(Uint32));
+			}
+
+			SDL_UnlockTexture(fieldPixels.texture);
+		}
+	}
+
+	fieldPixels.firstRow = firstRow;
+	fieldPixels.firstColumn = firstColumn;
+	fieldPixels.rows = rows;
+	fieldPixels.columns = columns;
+	fieldPixels.revision = revision;
+	fieldPixels.gameLost = gameLost;
+	fieldPixels.endless = endless;
+	fieldPixels.valid = true;
+
+	float tileSize = getTileScreenSize();
+	SDL_Rect sourceRect = { 0, 0, columns, rows };
+	SDL_FRect targetRect = { viewRect.x - viewX + firstColumn * tileSize, viewRect.y - viewY + firstRow * tileSize, columns * tileSize, rows * tileSize };
+
+	SDL_RenderSetClipRect(renderer, &viewRect);
+	SDL_RenderCopyF(renderer, fieldPixels.texture, &sourceRect, &targetRect);
+	SDL_RenderSetClipRect(renderer, NULL);
+}
+
+//Draw mine field
+//Only visible part of the field is drawn with single geometry call
+//Vertices are kept between frames and rebuilt when field or view changes, rows are split into bands built on worker threads
+void drawField(SDL_Renderer* renderer, SDL_Texture* fieldTexture)
+{
+	//Far zoomed out field has more tiles than sprites can show
+	if (getTileScreenSize() < PIXEL_TILE_PIXELS)
+	{
+		drawFieldPixels(renderer);
+		return;
+	}
+
+	SDL_Rect viewRect = getFieldViewRect();
+	bool gameLost = (gameState == GameState::LOST);
+
+	bool rebuild = !fieldGeometry.valid || fieldGeometry.revision != getFieldRevision() || fieldGeometry.gameLost != gameLost
+		|| fieldGeometry.viewX != viewX || fieldGeometry.viewY != viewY || fieldGeometry.viewZoom != viewZoom
+		|| !SDL_RectEquals(&fieldGeometry.viewRect, &viewRect);
+
+	if (rebuild)
+	{
+		float tileSize = getTileScreenSize();
+
+		int firstRow, firstColumn, lastRow, lastColumn;
+		getVisibleTiles(viewRect, firstRow, firstColumn, lastRow, lastColumn);
+
+		int columns = std::max(0, lastColumn - firstColumn);
+		int rows = std::max(0, lastRow - firstRow);
+		int tileCount = columns * rows;
+
+		//Indices are the same for every quad so they only need to grow
+		if ((int)fieldGeometry.indices.size() < tileCount * 6)
+		{
+			int oldCount = fieldGeometry.indices.size() / 6;
+			fieldGeometry.indices.resize(tileCount * 6);
+
+			for (int i = oldCount; i < tileCount; i++)
+			{
+				fieldGeometry.indices[i * 6 + 0] = i * 4 + 0;
+				fieldGeometry.indices[i * 6 + 1] = i * 4 + 1;
+				fieldGeometry.indices[i * 6 + 2] = i * 4 + 2;
+				fieldGeometry.indices[i * 6 + 3] = i * 4 + 2;
+				fieldGeometry.indices[i * 6 + 4] = i * 4 + 3;
+				fieldGeometry.indices[i * 6 + 5] = i * 4 + 0;
+			}
+		}
+
+		if ((int)fieldGeometry.vertices.size() < tileCount * 4)
+		{
+			fieldGeometry.vertices.resize(tileCount * 4);
+		}
+
+		int textureWidth, textureHeight;
+		SDL_QueryTexture(fieldTexture, NULL, NULL, &textureWidth, &textureHeight);
+
+		int lostBit = gameLost ? SPRITE_GAME_LOST : 0;
+		float originX = viewRect.x - viewX;
+		float originY = viewRect.y - viewY;
+		float u1 = (float)TILE_SIZE / textureWidth;
+		float spriteHeight = (float)TILE_SIZE / textureHeight;
+		SDL_Vertex* vertices = fieldGeometry.vertices.data();
+
+		//Every band writes only its own rows of vertex buffer
+		auto buildBand = [=](int band)
+		{
+			thread_local std::vector<Uint8> rowSprites;
+			rowSprites.resize(columns);
+
+			SDL_Color white = { 255, 255, 255, 255 };
+			int bandEnd = std::min(rows, (band + 1) * FIELD_BAND_ROWS);
+
+			for (int i = band * FIELD_BAND_ROWS; i < bandEnd; i++)
+			{
+				int row = firstRow + i;
+				//Select sprites for whole row without branching
+				getFieldRow(row, firstColumn, columns, rowSprites.data());
+
+				for (int col = 0; col < columns; col++)
+				{
+					rowSprites[col] = fieldSpriteTable.rows[rowSprites[col] | lostBit];
+				}
+
+				float y0 = originY + row * tileSize;
+				float y1 = y0 + tileSize;
+				SDL_Vertex* vertex = vertices + (size_t)i * columns * 4;
+
+				for (int col = 0; col < columns; col++, vertex += 4)
+				{
+					float x0 = originX + (firstColumn + col) * tileSize;
+					float x1 = x0 + tileSize;
+					float v0 = rowSprites[col] * spriteHeight;
+					float v1 = v0 + spriteHeight;
+
+					vertex[0] = { { x0, y0 }, white, { 0.0f, v0 } };
+					vertex[1] = { { x1, y0 }, white, { u1, v0 } };
+					vertex[2] = { { x1, y1 }, white, { u1, v1 } };
+					vertex[3] = { { x0, y1 }, white, { 0.0f, v1 } };
+				}
+			}
+		};
+
+		int bandCount = (rows + FIELD_BAND_ROWS - 1) / FIELD_BAND_ROWS;
+
+		if (tileCount >= PARALLEL_TILE_COUNT && threadPool != NULL)
+		{
+			threadPool->parallelFor(bandCount, buildBand);
+		}
+		else
+		{
+			for (int band = 0; band < bandCount; band++)
+			{
+				buildBand(band);
+			}
+		}
+
+		fieldGeometry.tileCount = tileCount;
+		fieldGeometry.revision = getFieldRevision();
+		fieldGeometry.gameLost = gameLost;
+		fieldGeometry.viewX = viewX;
+		fieldGeometry.viewY = viewY;
+		fieldGeometry.viewZoom = viewZoom;
+		fieldGeometry.viewRect = viewRect;
+		fieldGeometry.valid = true;
+	}
+
+	if (fieldGeometry.tileCount == 0)
+	{
+		return;
+	}
+
+	//Tiles on view border can be partially visible
+	SDL_RenderSetClipRect(renderer, &viewRect);
+	SDL_RenderGeometry(renderer, fieldTexture, fieldGeometry.vertices.data(), fieldGeometry.tileCount * 4, fieldGeometry.indices.data(), fieldGeometry.tileCount * 6);
+	SDL_RenderSetClipRect(renderer, NULL);
+}
+
+//Draw minimap with frame and rectangle showing visible part of the field
+void drawMinimap(SDL_Renderer* renderer)
+{
+	if (!isMinimapVisible() || isGeneratingField() || !minimap.update(renderer, minefield, gameState == GameState::LOST))
+	{
+		return;
+	}
+
+	SDL_Rect rect = getMinimapRect();
+	SDL_Rect frameRect = { rect.x - contentScale, rect.y - contentScale, rect.w + 2 * contentScale, rect.h + 2 * contentScale };
+
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+	SDL_RenderFillRect(renderer, &frameRect);
+	SDL_RenderCopy(renderer, minimap.getTexture(), NULL, &rect);
+
+	SDL_Rect viewRect = getFieldViewRect();
+	float scale = getMinimapScale();
+	SDL_Rect visibleRect = { rect.x + (int)(viewX * scale), rect.y + (int)(viewY * scale), std::max(1, (int)(viewRect.w * scale)), std::max(1, (int)(viewRect.h * scale)) };
+
+	if (SDL_IntersectRect(&visibleRect, &rect, &visibleRect))
+	{
+		SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+		SDL_RenderDrawRect(renderer, &visibleRect);
+	}
+}
+
+//Prepare new game with selected mode
+void prepareGame(int customWidth = 0, int customHeight = 0, int customMines = 0)
+{
+	switch (gameMode) //Predefined game modes
+	{
+		case GameMode::BEGINNER:
+			fieldWidth = 9;
+			fieldHeight = 9;
+			fieldMines = 10;
+		break;
+
+		case GameMode::ADVANCED:
+			fieldWidth = 16;
+			fieldHeight = 16;
+			fieldMines = 40;
+		break;
+
+		case GameMode::EXPERT:
+			fieldWidth = 30;
+			fieldHeight = 16;
+			fieldMines = 99;
+		break;
+
+		case GameMode::CUSTOM:
+			fieldWidth = customWidth;
+			fieldHeight = customHeight;
+			fieldMines = customMines;
+		break;
+
+		case GameMode::ENDLESS: //Window has size of expert field
+			fieldWidth = 30;
+			fieldHeight = 16;
+			fieldMines = 0;
+		break;
+	}
+
+	//Check if custom values are valid
+	if (gameMode == GameMode::CUSTOM)
+	{
+		if (fieldWidth < 9)
+			fieldWidth = 9;
+
+		if (fieldHeight < 9)
+			fieldHeight = 9;
+
+		if (fieldWidth > MAX_FIELD_SIZE)
+			fieldWidth = MAX_FIELD_SIZE;
+
+		if (fieldHeight > MAX_FIELD_SIZE)
+			fieldHeight = MAX_FIELD_SIZE;
+
+		if (fieldMines < 10)
+			fieldMines = 10;
+
+		if (fieldMines > (fieldWidth*fieldHeight) / 2) //At least half of fields should be empty
+			fieldMines = (fieldWidth*fieldHeight) / 2;
+	}
+
+	clickCount = 0;
+	practiceGame = false;
+	explodedRow = -1;
+	explodedColumn = -1;
+	minefield.reset(fieldWidth, fieldHeight, fieldMines);
+
+	//Keep seed until field is generated with it, so seed given on command line survives changing mode
+	if (gameSeedUsed)
+	{
+		gameSeed = seedGenerator.next();
+		gameSeedUsed = false;
+	}
+
+	if (gameMode == GameMode::ENDLESS)
+	{
+		endlessField.reset(gameSeed, endlessStorePath, ENDLESS_CHUNK_BUDGET);
+	}
+}
+
+//Generate new minefield (generates after first click so get position to prevent generating mine on this field)
+void generateField(int selectedRow, int selectedColumn)
+{
+	//Chunks of endless field are generated when they are needed
+	if (gameMode == GameMode::ENDLESS)
+	{
+		endlessField.start(selectedRow, selectedColumn);
+	}
+	else
+	{
+		minefield.generate(gameSeed, selectedRow, selectedColumn, threadPool);
+	}
+
+	gameSeedUsed = true;
+}
+
+//Uncover selected tile
+//Also set game state if player won or lost
+void uncoverTile(int row, int column)
+{
+	//Endless game can only be lost
+	if (gameMode == GameMode::ENDLESS)
+	{
+		if (!endlessField.uncover(row, column))
+		{
+			gameState = GameState::LOST;
+		}
+
+		return;
+	}
+
+	if (!minefield.uncover(row, column)) //Clicked on field with mine so game over
+	{
+		gameState = GameState::LOST;
+		return;
+	}
+
+	//Check if player won game (only mine tiles are left)
+	if (minefield.isCleared())
+	{
+		gameState = GameState::WON;
+	}
+}
+
+//Revert last move or repeat reverted one, lost game continues when losing move is reverted
+bool changeMove(bool redo)
+{
+	if (gameState != GameState::STARTED && gameState != GameState::LOST)
+	{
+		return false;
+	}
+
+	if (!(redo ? minefield.redo() : minefield.undo()))
+	{
+		return false;
+	}
+
+	//Clicked state isn't part of moves, so tile clicked by losing move has to be released here
+	if (explodedRow >= 0)
+	{
+		minefield.setClicked(explodedRow, explodedColumn, false);
+		explodedRow = -1;
+		explodedColumn = -1;
+	}
+
+	gameState = minefield.isExploded() ? GameState::LOST : GameState::STARTED;
+	practiceGame = true;
+
+	return true;
+}
+
+//Create history record of just finished game
+GameRecord createGameRecord(Uint32 time)
+{
+	GameRecord record = {};
+	record.seed = gameSeed;
+	record.width = fieldWidth;
+	record.height = fieldHeight;
+	record.mines = fieldMines;
+	record.time = time;
+	record.clicks = clickCount;
+	record.mode = gameMode;
+	record.result = (gameState == GameState::WON) ? RESULT_WON : RESULT_LOST;
+
+	return record;
+}
+
+//3BV of big field takes seconds, so it's computed from copy of mine bits on worker thread and record waits for it
+void addGameRecord(Uint32 time)
+{
+	PendingGameRecord pending = { createGameRecord(time), std::future<int>() };
+
+	if ((int64_t)fieldWidth * fieldHeight < ASYNC_GENERATE_TILES)
+	{
+		pending.record.bv = minefield.calculate3BV();
+	}
+	else
+	{
+		auto calculation = [mineBits = minefield.getMineBits(), width = fieldWidth, height = fieldHeight]()
+		{
+			return Minefield::calculate3BV(mineBits, width, height);
+		};
+
+		//Pool without workers would run calculation right here
+		if (threadPool->getThreadCount() == 0)
+		{
+			pending.bv = std::async(std::launch::async, std::move(calculation));
+		}
+		else
+		{
+			pending.bv = threadPool->submit(std::move(calculation));
+		}
+	}
+
+	pendingGameRecords.push_back(std::move(pending));
+}
+
+//Append records whose 3BV is ready, or all of them if wait is set
+void appendGameRecords(GameHistory& gameHistory, bool wait)
+{
+	while (!pendingGameRecords.empty())
+	{
+		PendingGameRecord& pending = pendingGameRecords.front();
+
+		if (pending.bv.valid())
+		{
+			if (!wait && pending.bv.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				return;
+			}
+
+			pending.record.bv = pending.bv.get();
+		}
+
+		gameHistory.append(pending.record);
+		pendingGameRecords.pop_front();
+	}
+}
+
+//Replay action describing current mark of the tile
+ReplayAction getMarkAction(int row, int column)
+{
+	if (getFieldTile(row, column) & FIELD_FLAG)
+	{
+		return ReplayAction::ACTION_FLAG;
+	}
+
+	if (getFieldTile(row, column) & FIELD_UNKNOWN)
+	{
+		return ReplayAction::ACTION_UNKNOWN;
+	}
+
+	return ReplayAction::ACTION_CLEAR;
+}
+
+//Get image from directory given with --assets if it's present there (allows replacing graphics without rebuilding)
+//Otherwise use image embedded in binary at build time
+RgbaImage loadImage(const std::string& assetsPath, const char* fileName, const EmbeddedImage& embeddedImage)
+{
+	RgbaImage image = { embeddedImage.pixels, embeddedImage.width, embeddedImage.height, false };
+	std::string imagePath = assetsPath + fileName;
+	std::error_code errorCode;
+
+	if (!assetsPath.empty() && std::filesystem::exists(imagePath, errorCode))
+	{
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+
+		if (pixels != NULL)
+		{
+			image = { pixels, width, height, true };
+		}
+		else
+		{
+			fprintf(stderr, "Failed loading %s, using embedded image\n", imagePath.c_str());
+		}
+	}
+
+	return image;
+}
+
+void freeImage(RgbaImage& image)
+{
+	if (image.loaded)
+	{
+		stbi_image_free((void*)image.pixels);
+	}
+
+	image.pixels = NULL;
+	image.loaded = false;
+}
+
+//Create texture directly from RGBA pixels
+SDL_Texture* textureFromImage(SDL_Renderer* renderer, const RgbaImage& image)
+{
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, image.width, image.height);
+
+	if (texture != NULL)
+	{
+		SDL_UpdateTexture(texture, NULL, image.pixels, image.width * 4);
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	}
+
+	return texture;
+}
+
+//Store best times in config structure
+void storeBestTimes(mINI::INIStructure& iniStructure, const BestTimes* bestTimes)
+{
+	iniStructure["Beginner"]["Name"] = bestTimes[0].playerName;
+	iniStructure["Beginner"]["Time"] = std::to_string(bestTimes[0].bestTime);
+
+	iniStructure["Advanced"]["Name"] = bestTimes[1].playerName;
+	iniStructure["Advanced"]["Time"] = std::to_string(bestTimes[1].bestTime);
+
+	iniStructure["Expert"]["Name"] = bestTimes[2].playerName;
+	iniStructure["Expert"]["Time"] = std::to_string(bestTimes[2].bestTime);
+}
+
+//Read config from memory mapped file, lines are tokenized in place without copying them
+bool readConfig(const std::string& configPath, mINI::INIStructure& iniStructure)
+{
+	MappedFile configMapping;
+
+	if (!configMapping.open(configPath))
+	{
+		return false;
+	}
+
+	iniStructure.clear();
+
+	mINI::INIReader reader(mINI::INIReader::inMemory);
+	return reader.parse(std::string_view((const char*)configMapping.getData(), configMapping.getSize()), iniStructure);
+}
+
+//Make sure written file reaches the disk, not just system cache
+bool syncFile(const std::string& path)
+{
+#if defined(WIN32) || defined(_WIN32)
+	int file = _open(path.c_str(), _O_RDWR | _O_BINARY);
+
+	if (file < 0)
+	{
+		return false;
+	}
+
+	bool synced = _commit(file) == 0;
+	_close(file);
+#else
+	int file = open(path.c_str(), O_RDWR);
+
+	if (file < 0)
+	{
+		return false;
+	}
+
+	bool synced = fsync(file) == 0;
+	close(file);
+#endif
+
+	return synced;
+}
+
+//Make sure renamed file is in directory on the disk (NTFS journals renames itself, so it's needed only on POSIX)
+bool syncDirectory(const std::string& path)
+{
+#if defined(WIN32) || defined(_WIN32)
+	(void)path;
+	return true;
+#else
+	int directory = open(path.empty() ? "." : path.c_str(), O_RDONLY);
+
+	if (directory < 0)
+	{
+		return false;
+	}
+
+	bool synced = fsync(directory) == 0;
+	close(directory);
+
+	return synced;
+#endif
+}
+
+//Write config to temporary file and replace old one with it, so interrupted write never leaves broken config
+//New file is synced before it replaces old one and directory after that, so journal can be cleared when it returns true
+bool writeConfig(const std::string& configPath, mINI::INIStructure& iniStructure)
+{
+	std::string temporaryPath = configPath + ".tmp";
+	std::error_code errorCode;
+
+	//Start from copy of current file so mINI keeps its layout
+	std::filesystem::copy_file(configPath, temporaryPath, std::filesystem::copy_options::overwrite_existing, errorCode);
+
+	mINI::INIFile temporaryFile(temporaryPath);
+
+	if (!temporaryFile.write(iniStructure) || !syncFile(temporaryPath))
+	{
+		std::filesystem::remove(temporaryPath, errorCode);
+		return false;
+	}
+
+	std::filesystem::rename(temporaryPath, configPath, errorCode);
+
+	return !errorCode && syncDirectory(std::filesystem::path(configPath).parent_path().string());
+}
+
+int main(int argc, char* argv[])
+{
+	SDL_Window* window = NULL;
+	SDL_Renderer* renderer = NULL;
+	SDL_Texture* fields = NULL, *faces = NULL, *display = NULL;
+	std::string assetsPath, prefPath;
+
+	contentScale = 1;
+
+	//Check if config directory is present and load it, try to create it otherwise
+	bool loadConfig = true;
+	bool lowLatency = false, dumpLatency = false, profileStartup = false, profileStartupJson = false, seedSet = false, pagedField = false;
+	Uint64 commandLineSeed = 0;
 
 	if (argc > 1)
 	{
@@ -633,6 +1470,52 @@ int main(int argc, char* argv[])
 				loadConfig = false;
 			}
 
+			if (argument == "--low-latency")
+			{
+				lowLatency = true;
+				dumpLatency = true;
+			}
+
+			if (argument == "--dump-latency")
+			{
+				dumpLatency = true;
+			}
+
+			if (argument == "--paged-field")
+			{
+				pagedField = true;
+			}
+
+			if (argument == "--profile-startup" || argument == "--profile-startup=json")
+			{
+				profileStartup = true;
+				profileStartupJson = (argument == "--profile-startup=json");
+			}
+
+			//Images in given directory replace embedded ones
+			if (argument.find("--assets=") == 0 && argument.size() > 9)
+			{
+				assetsPath = argument.substr(9);
+
+				if (assetsPath.back() != '/' && assetsPath.back() != PATH_SEPARATOR[0])
+				{
+					assetsPath += PATH_SEPARATOR;
+				}
+			}
+
+			if (argument.find("--seed=") == 0 && argument.size() > 7)
+			{
+				try
+				{
+					commandLineSeed = std::stoull(argument.substr(7));
+					seedSet = true;
+				}
+				catch (...)
+				{
+					fprintf(stderr, "Invalid seed %s\n", argument.c_str());
+				}
+			}
+
 			if (argument.find("--scale=") != std::string::npos && argument.size() > 8)
 			{
 				std::string scaleString = argument.substr(8, argument.size());
@@ -649,6 +1532,8 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	startupProfiler.mark("Command line");
+
 	if (loadConfig) //If load config is enabled then try to create pref path
 	{
 		char* prefLocation = SDL_GetPrefPath("DragonSWDev", "dsdmine"); //Try to create pref directory if it doesn't exists
@@ -664,6 +1549,8 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	startupProfiler.mark("SDL_GetPrefPath");
+
 	mINI::INIFile configFile(prefPath + "besttimes.ini");
 	mINI::INIStructure iniStructure;
 	BestTimes* bestTimes;
@@ -685,7 +1572,7 @@ int main(int argc, char* argv[])
 		loadConfig = configFile.generate(iniStructure);
 	}
 
-	if (loadConfig && configFile.read(iniStructure)) //Config loaded, get values
+	if (loadConfig && readConfig(prefPath + "besttimes.ini", iniStructure)) //Config loaded, get values
 	{
 		bestTimes = new BestTimes[3];
 
@@ -721,13 +1608,149 @@ int main(int argc, char* argv[])
 		contentScale = 1;
 	}
 
+	//Best times set after config was last written are kept in journal
+	BestTimesJournal bestTimesJournal;
+
+	if (loadConfig)
+	{
+		bestTimesJournal.open(prefPath + "besttimes.journal", [bestTimes](int mode, int time, const std::string& name)
+		{
+			if (mode >= GameMode::BEGINNER && mode <= GameMode::EXPERT)
+			{
+				bestTimes[mode].playerName = name;
+				bestTimes[mode].bestTime = time;
+			}
+		});
+
+		//Compact journal left by previous session
+		if (bestTimesJournal.getEntryCount() > 0)
+		{
+			storeBestTimes(iniStructure, bestTimes);
+
+			if (writeConfig(prefPath + "besttimes.ini", iniStructure))
+			{
+				bestTimesJournal.clear();
+			}
+		}
+	}
+
+	startupProfiler.mark("Config read");
+
+	//Every finished game is appended to history log
+	GameHistory gameHistory;
+
+	if (loadConfig)
+	{
+		gameHistory.open(prefPath + "history.bin");
+	}
+
+	//Best times of custom boards
+	Leaderboard leaderboard;
+
+	if (loadConfig)
+	{
+		leaderboard.open(prefPath + "leaderboard.bin");
+	}
+
+	//Every game is recorded and appended to replay archive when it ends
+	ReplayRecorder replayRecorder;
+	std::string replayArchivePath;
+
+	if (loadConfig)
+	{
+		replayArchivePath = prefPath + "replays.bin";
+	}
+
+	//Without config directory endless field and paged field use temporary directory
+	std::string pagedFieldPath;
+
+	if (loadConfig)
+	{
+		endlessStorePath = prefPath + "endless.bin";
+		pagedFieldPath = prefPath + "field.bin";
+	}
+	else
+	{
+		std::error_code errorCode;
+		endlessStorePath = (std::filesystem::temp_directory_path(errorCode) / "dsdmine-endless.bin").string();
+		pagedFieldPath = (std::filesystem::temp_directory_path(errorCode) / "dsdmine-field.bin").string();
+	}
+
+	if (pagedField)
+	{
+		minefield.setPagedStorage(pagedFieldPath);
+	}
+
+	startupProfiler.mark("Game history read");
+
+	threadPool = new ThreadPool();
+
+	//Images from --assets directory are decoded on worker threads while window and renderer are created
+	//Results are needed only when textures are uploaded
+	auto profiledLoadImage = [](const std::string& assetsPath, const char* fileName, const EmbeddedImage& embeddedImage)
+	{
+		double start = startupProfiler.now();
+		RgbaImage image = loadImage(assetsPath, fileName, embeddedImage);
+		startupProfiler.addBackgroundPhase(std::string("Load ") + fileName, start, startupProfiler.now());
+
+		return image;
+	};
+
+	std::future<RgbaImage> fieldsImageLoad = threadPool->submit([=]() { return profiledLoadImage(assetsPath, "tiles.png", embeddedTiles); });
+	std::future<RgbaImage> facesImageLoad = threadPool->submit([=]() { return profiledLoadImage(assetsPath, "faces.png", embeddedFaces); });
+	std::future<RgbaImage> displayImageLoad = threadPool->submit([=]() { return profiledLoadImage(assetsPath, "display.png", embeddedDisplay); });
+	std::future<RgbaImage> windowIconImageLoad = threadPool->submit([=]() { return profiledLoadImage(assetsPath, "icon.png", embeddedIcon); });
+
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO(); (void)io;
+	io.IniFilename = NULL; //Don't create ImGui ini file
+
+	//Font is rasterized at real pixel size instead of scaling 13 px font, so text stays sharp on high DPI
+	ImFontConfig fontConfig;
+	fontConfig.SizePixels = 13.0f * contentScale;
+	ImFont* font = io.Fonts->AddFontDefault(&fontConfig);
+
+	//Baked atlas is cached per font size in pref path, later launches skip rasterization
+	std::string fontAtlasCachePath;
+
+	if (loadConfig)
+	{
+		fontAtlasCachePath = prefPath + "fontatlas" + std::to_string((int)fontConfig.SizePixels) + ".bin";
+	}
+
+	//Font atlas is built on worker thread too, ImGui isn't used on main thread until it's done
+	std::future<void> fontAtlasBuild = threadPool->submit([&io, font, fontAtlasCachePath]()
+	{
+		double start = startupProfiler.now();
+
+		if (!fontAtlasCachePath.empty() && loadFontAtlasCache(fontAtlasCachePath, io.Fonts, font))
+		{
+			startupProfiler.addBackgroundPhase("Font atlas cache load", start, startupProfiler.now());
+			return;
+		}
+
+		unsigned char* pixels;
+		int width, height;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+		if (!fontAtlasCachePath.empty())
+		{
+			saveFontAtlasCache(fontAtlasCachePath, io.Fonts, font);
+		}
+
+		startupProfiler.addBackgroundPhase("Font atlas build", start, startupProfiler.now());
+	});
+
+	startupProfiler.mark("Worker start, ImGui context");
+
 	if (SDL_Init(SDL_INIT_VIDEO) != 0)
 	{
 		fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
 		return EXIT_FAILURE;
 	}
 
-	basePath = SDL_GetBasePath();
+	startupProfiler.mark("SDL_Init");
 
 	windowWidth = 154; //Initial window size for beginner mode
 	windowHeight = 199;
@@ -740,7 +1763,10 @@ int main(int argc, char* argv[])
 		return EXIT_FAILURE;
 	}
 
-	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
+	startupProfiler.mark("Window creation");
+
+	//Low latency mode presents frames without waiting for vertical sync
+	renderer = SDL_CreateRenderer(window, -1, lowLatency ? SDL_RENDERER_ACCELERATED : SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
 
 	if(renderer == NULL)
 	{
@@ -749,77 +1775,203 @@ int main(int argc, char* argv[])
 		return EXIT_FAILURE;
 	}
 
-	IMGUI_CHECKVERSION();
-	ImGui::CreateContext();
-	ImGuiIO& io = ImGui::GetIO(); (void)io;
-	io.IniFilename = NULL; //Don't create ImGui ini file
-	io.FontGlobalScale = contentScale;
-
+	startupProfiler.mark("Renderer creation");
+
+	fontAtlasBuild.wait();
+
+	startupProfiler.mark("Font atlas wait");
+
 	ImGui::StyleColorsDark();
 
 	// Setup Platform/Renderer backends
 	ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
 	ImGui_ImplSDLRenderer2_Init(renderer);
 
-	//Load assets from base directory
-	StbImage fieldsImage, facesImage, displayImage;
-	fieldsImage.pixels = stbi_load((basePath + "assets"+PATH_SEPARATOR+"tiles.png").c_str(), &fieldsImage.width, &fieldsImage.height, &fieldsImage.channels, 0);
-	facesImage.pixels = stbi_load((basePath + "assets"+PATH_SEPARATOR+"faces.png").c_str(), &facesImage.width, &facesImage.height, &facesImage.channels, 0);
-	displayImage.pixels = stbi_load((basePath + "assets"+PATH_SEPARATOR+"display.png").c_str(), &displayImage.width, &displayImage.height, &displayImage.channels, 0);
+	startupProfiler.mark("ImGui backend init");
 
-	if (fieldsImage.pixels != NULL && facesImage.pixels != NULL && displayImage.pixels != NULL)
-	{
-		fields = SDL_CreateTextureFromSurface(renderer, surfaceFromStbImage(fieldsImage));
-		faces = SDL_CreateTextureFromSurface(renderer, surfaceFromStbImage(facesImage));
-		display = SDL_CreateTextureFromSurface(renderer, surfaceFromStbImage(displayImage));
-	}
+	//Images in --assets directory are optional and replace embedded ones
+	RgbaImage fieldsImage = fieldsImageLoad.get();
+	RgbaImage facesImage = facesImageLoad.get();
+	RgbaImage displayImage = displayImageLoad.get();
+	RgbaImage windowIconImage = windowIconImageLoad.get();
+
+	fields = textureFromImage(renderer, fieldsImage);
+	faces = textureFromImage(renderer, facesImage);
+	display = textureFromImage(renderer, displayImage);
 
 	if (fields == NULL || faces == NULL || display == NULL)
 	{
-		fprintf(stderr, "Failed loading assets!\n");
+		fprintf(stderr, "Failed creating textures: %s\n", SDL_GetError());
 
 		return EXIT_FAILURE;
 	}
 
-	//Try to load icon
-	StbImage windowIconImage;
-	windowIconImage.pixels = stbi_load((basePath + "assets"+PATH_SEPARATOR+"icon.png").c_str(), &windowIconImage.width, &windowIconImage.height, &windowIconImage.channels, 0);
-	SDL_Surface* windowIcon;
+	computeSpriteColours(fieldsImage);
 
-	if (windowIconImage.pixels != NULL)
-	{
-		windowIcon = surfaceFromStbImage(windowIconImage);
-	}
+	//Window icon is copied by SDL so surface can be freed right away
+	SDL_Surface* windowIcon = SDL_CreateRGBSurfaceWithFormatFrom((void*)windowIconImage.pixels, windowIconImage.width, windowIconImage.height, 32, windowIconImage.width * 4, SDL_PIXELFORMAT_RGBA32);
 
 	if (windowIcon)
 	{
 		SDL_SetWindowIcon(window, windowIcon);
+		SDL_FreeSurface(windowIcon);
 	}
 
-	unsigned timeSeed = std::chrono::system_clock::now().time_since_epoch().count();
-	randomEngine.seed(timeSeed);
+	freeImage(fieldsImage);
+	freeImage(facesImage);
+	freeImage(displayImage);
+	freeImage(windowIconImage);
+
+	startupProfiler.mark("Asset wait and upload");
+
+	Uint64 timeSeed = std::chrono::system_clock::now().time_since_epoch().count();
+	seedGenerator = Random(seedSet ? commandLineSeed : timeSeed);
 
 	gameMode = GameMode::BEGINNER;
+	minefield.setUndoLimit(UNDO_LIMIT);
 	prepareGame();
+	resetView();
+
+	//First game uses exactly the seed from command line
+	if (seedSet)
+	{
+		gameSeed = commandLineSeed;
+	}
+
+	SDL_SetWindowTitle(window, ("dsdmine - seed " + std::to_string(gameSeed)).c_str());
+	replayRecorder.start(gameMode, fieldWidth, fieldHeight, fieldMines, gameSeed, SDL_GetTicks());
 
 	ImVec4 clear_color = ImVec4(0.75f, 0.75f, 0.75f, 1.00f);
 
-	bool isRunning = true, popupWindow = false, changeMode = false, gameMenuVisible = false, helpMenuVisible = false;
-	int customWidth = fieldWidth, customHeight = fieldHeight, customMines = fieldMines, clickedRow = -1, clickedColumn = -1, startTime;
+	bool isRunning = true, popupWindow = false, changeMode = false, undoMove = false, redoMove = false, gameMenuVisible = false, helpMenuVisible = false, draggingView = false, draggingMinimap = false;
+	int customWidth = fieldWidth, customHeight = fieldHeight, customMines = fieldMines, clickedRow = -1, clickedColumn = -1, startTime = 0, leaderboardPage = 0;
+	Uint32 finishTime = 0; //Time of last finished game in milliseconds
 	gameTime = 0;
 	WindowType windowType; //Decide which window should be drawn
 	FaceState faceState = FaceState::NORMAL, oldFaceState = FaceState::NORMAL;
 	char inputName[14] = "Unknown";
 
+	//Continue game that was in progress when dsdmine was closed
+	SavedGameInfo savedGameInfo;
+
+	if (loadConfig && loadGame(prefPath + "savedgame.bin", minefield, savedGameInfo, threadPool) && savedGameInfo.mode < GameHistory::MODE_COUNT)
+	{
+		gameMode = (GameMode)savedGameInfo.mode;
+		fieldWidth = customWidth = minefield.getWidth();
+		fieldHeight = customHeight = minefield.getHeight();
+		fieldMines = customMines = minefield.getMines();
+		gameSeed = savedGameInfo.seed;
+		gameSeedUsed = true;
+		clickCount = savedGameInfo.clickCount;
+		practiceGame = savedGameInfo.practice;
+		gameState = GameState::STARTED;
+		startTime = SDL_GetTicks() - savedGameInfo.gameTime;
+
+		fitWindowToField(window);
+		SDL_SetWindowTitle(window, ("dsdmine - seed " + std::to_string(gameSeed)).c_str());
+		resetView();
+
+		//Actions before saving aren't known, so replay of resumed game can't be verified
+		replayRecorder.discard();
+
+		startupProfiler.mark("Saved game load");
+	}
+	else if (loadConfig)
+	{
+		//Saved game with unknown mode could already replace the field
+		prepareGame();
+	}
+
+	//Input events (performance counter values) that weren't presented yet
+	LatencyHistogram latencyHistogram;
+	std::vector<Uint64> pendingInputs;
+	double performanceFrequency = (double)SDL_GetPerformanceFrequency();
+
 	ImGuiStyle* style = &ImGui::GetStyle();
 	style->ScaleAllSizes(contentScale);
 
+	startupProfiler.mark("Game setup");
+	bool firstFrame = true;
+
+	//Uncover clicked tile, first click generates the field and starts the game
+	//Action time is also start time of the game when it's the first reveal, so game time matches recorded actions
+	auto revealTile = [&](int row, int column, Uint32 actionTime)
+	{
+		if (gameState == GameState::INITIALIZED) //Field is not generated - generate new
+		{
+			generateField(row, column);
+			gameState = GameState::STARTED;
+			startTime = actionTime;
+		}
+
+		clickCount++;
+		replayRecorder.addAction(ReplayAction::ACTION_REVEAL, row * fieldWidth + column, actionTime);
+		uncoverTile(row, column);
+
+		if (gameState == GameState::LOST || gameState == GameState::WON)
+		{
+			finishTime = actionTime - startTime;
+
+			if (!practiceGame && gameMode != GameMode::ENDLESS)
+			{
+				addGameRecord(finishTime);
+				appendGameRecords(gameHistory, false);
+			}
+
+			replayRecorder.finish(replayArchivePath, (gameState == GameState::WON) ? REPLAY_WON : REPLAY_LOST, finishTime);
+		}
+
+		if (gameState == GameState::LOST)
+		{
+			exposeField();
+			faceState = FaceState::GAME_LOST;
+		}
+		else if (gameState == GameState::WON)
+		{
+			faceState = FaceState::GAME_WON;
+
+			//Reverted moves disqualify the game from best times
+			if (!practiceGame && gameMode != GameMode::CUSTOM && loadConfig)
+			{
+				if (gameTime < bestTimes[gameMode].bestTime)
+				{
+					popupWindow = true;
+					windowType = WindowType::NEW_TIME;
+				}
+			}
+			else if (!practiceGame && gameMode == GameMode::CUSTOM && leaderboard.isBestTime(fieldWidth, fieldHeight, fieldMines, finishTime))
+			{
+				popupWindow = true;
+				windowType = WindowType::NEW_TIME;
+			}
+		}
+
+		if (gameState != GameState::LOST) //Leave field clicked after game over to show it after exposing field
+		{
+			setTileClicked(row, column, false);
+		}
+		else
+		{
+			explodedRow = row;
+			explodedColumn = column;
+		}
+	};
+
 	while(isRunning)
 	{
 		SDL_Event event;
 
-		while (SDL_PollEvent(&event))
+		//In low latency mode sleep until input arrives and draw frame right after it
+		//Otherwise frame rate is limited by vertical sync
+		bool hasEvent = lowLatency ? SDL_WaitEventTimeout(&event, LOW_LATENCY_IDLE_TIMEOUT) : SDL_PollEvent(&event);
+
+		for (; hasEvent; hasEvent = SDL_PollEvent(&event))
 		{
+			if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP || event.type == SDL_MOUSEWHEEL)
+			{
+				pendingInputs.push_back(SDL_GetPerformanceCounter());
+			}
+
 			ImGui_ImplSDL2_ProcessEvent(&event);
 
 			if (event.type == SDL_QUIT)
@@ -842,49 +1994,132 @@ int main(int argc, char* argv[])
 				SDL_GetMouseState(&x, &y);
 
 				//Check if player is clicking face (using left mouse button)
-				if (event.button.button == SDL_BUTTON_LEFT &&
-					y >= (20 * contentScale) && y <= (20 * contentScale) + (FACE_SIZE * contentScale) && 
-					x >= ((TILE_SIZE * contentScale) * fieldWidth + (10 * contentScale)) / 2 - (FACE_SIZE * contentScale) / 2 && 
-					x <= ((TILE_SIZE * contentScale) * fieldWidth + (10 * contentScale)) / 2 + (FACE_SIZE * contentScale) / 2)
+				if (event.button.button == SDL_BUTTON_LEFT && isOnFace(x, y))
 				{
 					oldFaceState = faceState;
 					faceState = FaceState::NORMAL_CLICK;
 				}
 
-				//Check if player is clicking field (only if game is not finished)
-				if ((gameState == GameState::INITIALIZED || gameState == GameState::STARTED) 
-					&& y >= (50 * contentScale) 
-					&& y <= (windowHeight * contentScale) - (5 * contentScale) 
-					&& x >= (5 * contentScale) 
-					&& x <= (windowWidth * contentScale) - (5 * contentScale))
+				//Middle mouse button drags field view
+				if (event.button.button == SDL_BUTTON_MIDDLE)
 				{
-					//Set mouse position relative to the field (top left of the field will be 0,0)
-					x -= (5 * contentScale);
-					y -= (50 * contentScale);
+					SDL_Rect viewRect = getFieldViewRect();
+					SDL_Point mousePoint = { x, y };
+					draggingView = SDL_PointInRect(&mousePoint, &viewRect);
+				}
 
-					//Calculate which tile was clicked
-					int row, column;
+				//Left click on minimap moves field view there
+				if (event.button.button == SDL_BUTTON_LEFT && isOnMinimap(x, y))
+				{
+					draggingMinimap = true;
+					moveViewToMinimap(x, y);
+				}
 
-					row = y / (TILE_SIZE * contentScale);
-					column = x / (TILE_SIZE *  contentScale);
+				//Calculate which tile was clicked
+				int row, column;
 
+				//Check if player is clicking field (only if game is not finished and field isn't being generated)
+				if ((gameState == GameState::INITIALIZED || gameState == GameState::STARTED) && !isGeneratingField() && getTileAt(x, y, &row, &column))
+				{
 					//Check if tile is selectable (if it was clicked with left mouse button)
-					if (event.button.button == SDL_BUTTON_LEFT && isSelectable(row, column))
+					if (event.button.button == SDL_BUTTON_LEFT && isTileSelectable(row, column))
 					{
 						clickedRow = row;
 						clickedColumn = column;
 
-						fieldArray[row][column].isClicked = true; //Mark tile as clicked
+						setTileClicked(row, column, true); //Mark tile as clicked
 
 						faceState = FaceState::FIELD_CLICK;
 					}
 					else if (event.button.button == SDL_BUTTON_RIGHT) //Mark tile
 					{
+						clickCount++;
 						markTile(row, column);
+
+						if (!(getFieldTile(row, column) & FIELD_VISIBLE))
+						{
+							replayRecorder.addAction(getMarkAction(row, column), row * fieldWidth + column, SDL_GetTicks());
+						}
 					}
 				}
 			}
 
+			if (event.type == SDL_MOUSEMOTION && draggingView)
+			{
+				panView(-event.motion.xrel, -event.motion.yrel);
+			}
+
+			if (event.type == SDL_MOUSEMOTION && draggingMinimap)
+			{
+				moveViewToMinimap(event.motion.x, event.motion.y);
+			}
+
+			//Zoom field view with mouse wheel (around cursor position)
+			if (event.type == SDL_MOUSEWHEEL && !popupWindow && !gameMenuVisible && !helpMenuVisible && event.wheel.y != 0)
+			{
+				int x, y;
+				SDL_GetMouseState(&x, &y);
+
+				zoomView(std::pow(1.25f, (float)event.wheel.y), x, y);
+			}
+
+			//Move field view with arrow keys
+			if (event.type == SDL_KEYDOWN && !popupWindow)
+			{
+				float step = getTileScreenSize() * 4;
+
+				switch (event.key.keysym.sym)
+				{
+					case SDLK_LEFT:
+						panView(-step, 0);
+					break;
+
+					case SDLK_RIGHT:
+						panView(step, 0);
+					break;
+
+					case SDLK_UP:
+						panView(0, -step);
+					break;
+
+					case SDLK_DOWN:
+						panView(0, step);
+					break;
+
+					//Ctrl+Z reverts move, Ctrl+Y or Ctrl+Shift+Z repeats it
+					case SDLK_z:
+						if (event.key.keysym.mod & KMOD_CTRL)
+						{
+							if (event.key.keysym.mod & KMOD_SHIFT)
+							{
+								redoMove = true;
+							}
+							else
+							{
+								undoMove = true;
+							}
+						}
+					break;
+
+					case SDLK_y:
+						if (event.key.keysym.mod & KMOD_CTRL)
+						{
+							redoMove = true;
+						}
+					break;
+				}
+			}
+
+			if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_MIDDLE)
+			{
+				draggingView = false;
+			}
+
+			if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_LEFT)
+			{
+				draggingMinimap = false;
+			}
+
 			//Handle mouse button up
 			if (event.type == SDL_MOUSEBUTTONUP && !popupWindow)
 			{
@@ -896,10 +2131,7 @@ int main(int argc, char* argv[])
 				if (faceState == FaceState::NORMAL_CLICK)
 				{
 					//Check if cursor is still on face
-					if (event.button.button == SDL_BUTTON_LEFT &&
-					y >= (20 * contentScale) && y <= (20 * contentScale) + (FACE_SIZE * contentScale) && 
-					x >= ((TILE_SIZE * contentScale) * fieldWidth + (10 * contentScale)) / 2 - (FACE_SIZE * contentScale) / 2 && 
-					x <= ((TILE_SIZE * contentScale) * fieldWidth + (10 * contentScale)) / 2 + (FACE_SIZE * contentScale) / 2)
+					if (event.button.button == SDL_BUTTON_LEFT && isOnFace(x, y))
 					{
 						changeMode = true;
 					}
@@ -916,64 +2148,32 @@ int main(int argc, char* argv[])
 				//Some tile was clicked - check if cursor is still on that field
 				if (clickedRow >= 0 && clickedColumn >= 0)
 				{
+					int row, column;
+
 					//Check if mouse is still on field
-					if (y >= (50 * contentScale) 
-					&& y <= (windowHeight * contentScale) - (5 * contentScale) 
-					&& x >= (5 * contentScale) 
-					&& x <= (windowWidth * contentScale) - (5 * contentScale))
+					if (getTileAt(x, y, &row, &column))
 					{
-						x -= (5 * contentScale);
-						y -= (50 * contentScale);
-
-						int row, column;
-
-						row = y / (TILE_SIZE * contentScale);
-						column = x / (TILE_SIZE * contentScale);
-
 						//Still the same field - perform action
 						if (row == clickedRow && column == clickedColumn)
 						{
-							if (gameState == GameState::INITIALIZED) //Field is not generated - generate new
-							{
-								generateField(row, column);
-								gameState = GameState::STARTED;
-								startTime = SDL_GetTicks();
-							}
-
-							uncoverTile(row, column);
-
-							if (gameState == GameState::LOST)
+							//Field that takes long to generate is generated on worker thread, click is applied when it's done
+							if (gameState == GameState::INITIALIZED && gameMode != GameMode::ENDLESS && (int64_t)fieldWidth * fieldHeight >= ASYNC_GENERATE_TILES)
 							{
-								exposeField();
-								faceState = FaceState::GAME_LOST;
+								startFieldGeneration(row, column);
 							}
-							else if (gameState == GameState::WON)
+							else
 							{
-								faceState = FaceState::GAME_WON;
-
-								if (gameMode != GameMode::CUSTOM && loadConfig)
-								{
-									if (gameTime < bestTimes[gameMode].bestTime)
-									{
-										popupWindow = true;
-										windowType = WindowType::NEW_TIME;
-									}
-								}
-							}
-
-							if (gameState != GameState::LOST) //Leave field clicked after game over to show it after exposing field
-							{
-								fieldArray[clickedRow][clickedColumn].isClicked = false;
+								revealTile(row, column, SDL_GetTicks());
 							}
 						}
 						else
 						{
-							fieldArray[clickedRow][clickedColumn].isClicked = false;
+							setTileClicked(clickedRow, clickedColumn, false);
 						}
 					}
 					else //Mouse outside field - clear tile that was clicked
 					{
-						fieldArray[clickedRow][clickedColumn].isClicked = false;
+						setTileClicked(clickedRow, clickedColumn, false);
 					}
 
 					clickedRow = -1;
@@ -987,10 +2187,50 @@ int main(int argc, char* argv[])
 			}
 		}
 
+		appendGameRecords(gameHistory, false);
+
+		//Field generated on worker thread is ready, first click is applied now and game time starts
+		//If game was changed meanwhile, click belongs to abandoned field
+		if (isGeneratingField() && fieldGeneration.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			fieldGeneration.get();
+			fieldGeometry.valid = false;
+			fieldPixels.valid = false;
+			gameSeedUsed = true;
+
+			if (!changeMode)
+			{
+				gameState = GameState::STARTED;
+				startTime = SDL_GetTicks();
+				revealTile(pendingRow, pendingColumn, startTime);
+			}
+
+			pendingRow = -1;
+			pendingColumn = -1;
+		}
+
+		//Reverted move can't be verified by replay, so replay of the game is dropped
+		if ((undoMove || redoMove) && changeMove(redoMove))
+		{
+			faceState = (gameState == GameState::LOST) ? FaceState::GAME_LOST : FaceState::NORMAL;
+			replayRecorder.discard();
+		}
+
+		undoMove = false;
+		redoMove = false;
+
 		//Change window size to fit selected mode
 		//Also change game mode
-		if (changeMode)
+		//Field that is being generated can't be reset, so change waits until generation is done
+		if (changeMode && !isGeneratingField())
 		{
+			//Game in progress is abandoned
+			if (gameState == GameState::STARTED)
+			{
+				replayRecorder.addAction(ReplayAction::ACTION_RESTART, 0, SDL_GetTicks());
+				replayRecorder.finish(replayArchivePath, REPLAY_ABANDONED, SDL_GetTicks() - startTime);
+			}
+
 			if (gameMode != GameMode::CUSTOM)
 			{
 				prepareGame();
@@ -1005,12 +2245,19 @@ int main(int argc, char* argv[])
 			customHeight = fieldHeight;
 			customMines = fieldMines;
 
-			//Window width is supposed to be field tile width * field width + 10 (5px margin on each side)
-			//Window hight is same but top margin should be bigger to make room for display and face
-			windowWidth = TILE_SIZE * fieldWidth + 10;
-			windowHeight = TILE_SIZE * fieldHeight + 10 + 45;
+			fitWindowToField(window);
+			SDL_SetWindowTitle(window, ("dsdmine - seed " + std::to_string(gameSeed)).c_str());
+			//Endless field can't be replayed
+			if (gameMode != GameMode::ENDLESS)
+			{
+				replayRecorder.start(gameMode, fieldWidth, fieldHeight, fieldMines, gameSeed, SDL_GetTicks());
+			}
+			else
+			{
+				replayRecorder.discard();
+			}
 
-			SDL_SetWindowSize(window, windowWidth * contentScale, windowHeight * contentScale);
+			resetView();
 
 			gameState = GameState::INITIALIZED;
 			faceState = FaceState::NORMAL;
@@ -1050,6 +2297,18 @@ int main(int argc, char* argv[])
 					changeMode = true;
 				}
 
+				bool moveChangeable = (gameState == GameState::STARTED || gameState == GameState::LOST);
+
+				if (ImGui::MenuItem("Undo", "Ctrl+Z", false, moveChangeable && minefield.canUndo()))
+				{
+					undoMove = true;
+				}
+
+				if (ImGui::MenuItem("Redo", "Ctrl+Y", false, moveChangeable && minefield.canRedo()))
+				{
+					redoMove = true;
+				}
+
 				ImGui::Separator();
 
 				if (ImGui::MenuItem("Unknown (?)", NULL, marksEnabled, true))
@@ -1092,6 +2351,15 @@ int main(int argc, char* argv[])
 					windowType = WindowType::CUSTOM_GAME;
 				}
 
+				if (ImGui::MenuItem("Endless", NULL, (gameMode == GameMode::ENDLESS), true))
+				{
+					if (gameMode != GameMode::ENDLESS)
+					{
+						gameMode = GameMode::ENDLESS;
+						changeMode = true;
+					}
+				}
+
 				ImGui::Separator();
 
 				if (ImGui::MenuItem("Quit"))
@@ -1116,6 +2384,18 @@ int main(int argc, char* argv[])
 					windowType = WindowType::BEST_SCORES;
 				}
 
+				if (ImGui::MenuItem("Statistics", NULL, false, !popupWindow))
+				{
+					popupWindow = true;
+					windowType = WindowType::STATISTICS;
+				}
+
+				if (ImGui::MenuItem("Input latency", NULL, false, !popupWindow))
+				{
+					popupWindow = true;
+					windowType = WindowType::INPUT_LATENCY;
+				}
+
 				ImGui::Separator();
 
 				if (ImGui::MenuItem("About", NULL, false, !popupWindow))
@@ -1134,6 +2414,20 @@ int main(int argc, char* argv[])
 				ImGui::EndMainMenuBar();
 		}
 
+		//Field is hidden until it's generated, progress is shown over it
+		if (isGeneratingField())
+		{
+			SDL_Rect viewRect = getFieldViewRect();
+
+			ImGui::SetNextWindowPos(ImVec2(viewRect.x + viewRect.w / 2.0f, viewRect.y + viewRect.h / 2.0f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+			ImGui::Begin("Generating field", NULL, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing);
+
+			ImGui::Text("Generating field...");
+			ImGui::ProgressBar(minefield.getGenerateProgress(), ImVec2(120.0f * contentScale, 0.0f));
+
+			ImGui::End();
+		}
+
 		if (popupWindow)
 		{
 			//Setup new window sizes and position for beginner size to make sure they will fit
@@ -1191,6 +2485,37 @@ int main(int argc, char* argv[])
 					ImGui::Text(("Expert: %ds " + bestTimes[2].playerName).c_str(), bestTimes[2].bestTime);
 				}
 
+				//Custom boards are shown one per page, only shown board is read from leaderboard file
+				if (leaderboard.getBoardCount() > 0)
+				{
+					leaderboardPage = std::clamp(leaderboardPage, 0, leaderboard.getBoardCount() - 1);
+					LeaderboardRecord board = leaderboard.getBoard(leaderboardPage);
+
+					ImGui::Separator();
+					ImGui::Text("Custom %dx%d, %d mines", board.width, board.height, board.mines);
+
+					for (int i = 0; i < (int)board.timeCount && i < Leaderboard::TIMES_PER_BOARD; i++)
+					{
+						ImGui::Text("%d. %.3fs %s", i + 1, board.times[i].time / 1000.0, board.times[i].name);
+					}
+
+					if (ImGui::ArrowButton("##previous", ImGuiDir_Left))
+					{
+						leaderboardPage--;
+					}
+
+					ImGui::SameLine();
+					ImGui::Text("%d/%d", leaderboardPage + 1, leaderboard.getBoardCount());
+					ImGui::SameLine();
+
+					if (ImGui::ArrowButton("##next", ImGuiDir_Right))
+					{
+						leaderboardPage++;
+					}
+
+					ImGui::Separator();
+				}
+
 				if (ImGui::Button("Ok"))
 				{
 					popupWindow = false;
@@ -1198,10 +2523,14 @@ int main(int argc, char* argv[])
 
 				if (ImGui::Button("Reset") && loadConfig)
 				{
+					leaderboard.clear();
+
 					for (int i = 0; i < 3; i++)
 					{
 						bestTimes[i].playerName = "Unknown";
 						bestTimes[i].bestTime = 999;
+
+						bestTimesJournal.append(i, bestTimes[i].bestTime, bestTimes[i].playerName);
 					}
 				}
 
@@ -1233,15 +2562,80 @@ int main(int argc, char* argv[])
 
 				if (ImGui::Button("Ok"))
 				{
-					if (loadConfig)
+					if (gameMode == GameMode::CUSTOM)
+					{
+						leaderboard.insert(fieldWidth, fieldHeight, fieldMines, finishTime, inputName);
+					}
+					else if (loadConfig)
 					{
 						bestTimes[gameMode].playerName = inputName;
 						bestTimes[gameMode].bestTime = gameTime;
+
+						//Persist record right away so it survives crash
+						bestTimesJournal.append(gameMode, gameTime, inputName);
+					}
+
+					popupWindow = false;
+				}
+
+				ImGui::End();
+			}
+			else if (windowType == WindowType::STATISTICS)
+			{
+				ImGui::Begin("Statistics");
+
+				const char* modeNames[GameHistory::MODE_COUNT] = { "Beginner", "Advanced", "Expert", "Custom" };
+
+				for (int i = 0; i < GameHistory::MODE_COUNT; i++)
+				{
+					const GameStatistics& statistics = gameHistory.getStatistics(i);
+
+					ImGui::Text("%s: %d won of %d", modeNames[i], statistics.won, statistics.played);
+
+					if (statistics.won > 0)
+					{
+						double averageTime = (double)statistics.wonTimeSum / statistics.won / 1000.0;
+
+						ImGui::Text("Best: %.3fs Average: %.3fs", statistics.bestTime / 1000.0, averageTime);
+
+						if (statistics.wonTimeSum > 0)
+						{
+							ImGui::Text("Average 3BV/s: %.2f", statistics.bvSum / (statistics.wonTimeSum / 1000.0));
+						}
 					}
+				}
+
+				if (ImGui::Button("Ok"))
+				{
+					popupWindow = false;
+				}
+
+				ImGui::End();
+			}
+			else if (windowType == WindowType::INPUT_LATENCY)
+			{
+				ImGui::Begin("Input latency");
+
+				ImGui::Text(lowLatency ? "Low latency mode" : "Vertical sync mode");
+				ImGui::Text("Samples: %d", latencyHistogram.getSampleCount());
+				ImGui::Text("Mean: %.2f ms Max: %.2f ms", latencyHistogram.getMean(), latencyHistogram.getMax());
+				ImGui::Text("p50: %.1f ms p99: %.1f ms", latencyHistogram.getPercentile(50), latencyHistogram.getPercentile(99));
+
+				ImGui::PlotHistogram("##latency", [](void* data, int index) { return (float)((LatencyHistogram*)data)->getBucket(index); },
+					&latencyHistogram, LatencyHistogram::BUCKET_COUNT, 0, "0-50 ms", 0.0f, FLT_MAX, ImVec2(0, 40 * contentScale));
 
+				if (ImGui::Button("Ok"))
+				{
 					popupWindow = false;
 				}
 
+				ImGui::SameLine();
+
+				if (ImGui::Button("Reset"))
+				{
+					latencyHistogram.reset();
+				}
+
 				ImGui::End();
 			}
 		}
@@ -1249,45 +2643,100 @@ int main(int argc, char* argv[])
 		// Rendering
 		ImGui::Render();
 
-		drawDisplay(renderer, display, gameTime, flagCount, windowWidth);
+		//Endless field has no mine count, so placed flags are shown instead
+		drawDisplay(renderer, display, gameTime, (gameMode == GameMode::ENDLESS) ? endlessField.getFlagCount() : minefield.getFlagCount(), windowWidth);
 
 		drawFace(renderer, faces, faceState);
 
 		drawField(renderer, fields);
 
+		drawMinimap(renderer);
+
 		ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
 
 		SDL_RenderPresent(renderer);
+
+		if (firstFrame)
+		{
+			startupProfiler.mark("First frame");
+
+			if (profileStartup)
+			{
+				startupProfiler.print(stdout, profileStartupJson);
+				fflush(stdout);
+			}
+
+			firstFrame = false;
+		}
+
+		//Record time from input to present for every input handled in this frame
+		Uint64 presentTime = SDL_GetPerformanceCounter();
+
+		for (Uint64 inputTime : pendingInputs)
+		{
+			latencyHistogram.addSample((presentTime - inputTime) * 1000.0 / performanceFrequency);
+		}
+
+		pendingInputs.clear();
 	}
 
-	//Config loaded, store settings before ending game
-	if (loadConfig)
+	if (dumpLatency)
+	{
+		latencyHistogram.print(stdout);
+	}
+
+	if (gameState == GameState::STARTED)
+	{
+		replayRecorder.addAction(ReplayAction::ACTION_RESTART, 0, SDL_GetTicks());
+		replayRecorder.finish(replayArchivePath, REPLAY_ABANDONED, SDL_GetTicks() - startTime);
+	}
+
+	//Generation can't be interrupted, field is discarded when it's done
+	if (isGeneratingField())
 	{
-		iniStructure["Beginner"]["Name"] = bestTimes[0].playerName;
-		iniStructure["Beginner"]["Time"] = std::to_string(bestTimes[0].bestTime);
+		fieldGeneration.wait();
+	}
+
+	appendGameRecords(gameHistory, true);
 
-		iniStructure["Advanced"]["Name"] = bestTimes[1].playerName;
-		iniStructure["Advanced"]["Time"] = std::to_string(bestTimes[1].bestTime);
+	//Game in progress is saved so it can be continued on next launch
+	if (loadConfig)
+	{
+		std::string savedGamePath = prefPath + "savedgame.bin";
+		SavedGameInfo savedGameInfo = { gameMode, gameSeed, SDL_GetTicks() - startTime, clickCount, practiceGame };
 
-		iniStructure["Expert"]["Name"] = bestTimes[2].playerName;
-		iniStructure["Expert"]["Time"] = std::to_string(bestTimes[2].bestTime);
+		if (gameState != GameState::STARTED || gameMode == GameMode::ENDLESS || !saveGame(savedGamePath, minefield, savedGameInfo, threadPool))
+		{
+			std::error_code errorCode;
+			std::filesystem::remove(savedGamePath, errorCode);
+		}
+	}
 
+	//Config loaded, store settings before ending game
+	if (loadConfig)
+	{
+		storeBestTimes(iniStructure, bestTimes);
 		iniStructure["Render"]["Scale"] = std::to_string(contentScale);
 
-		configFile.write(iniStructure);
+		if (writeConfig(prefPath + "besttimes.ini", iniStructure))
+		{
+			bestTimesJournal.clear();
+		}
 	}
 
-	if (windowIcon)
+	endlessField.close();
+	delete threadPool;
+
+	minimap.destroy();
+
+	if (fieldPixels.texture != NULL)
 	{
-		SDL_FreeSurface(windowIcon);
+		SDL_DestroyTexture(fieldPixels.texture);
 	}
 
 	SDL_DestroyTexture(fields);
 	SDL_DestroyTexture(faces);
 	SDL_DestroyTexture(display);
-	stbi_image_free(fieldsImage.pixels);
-	stbi_image_free(facesImage.pixels);
-	stbi_image_free(displayImage.pixels);
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
@@ -0,0 +1,528 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "endlessfield.h"
+#include "random.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#define ENDLESS_MINE_THRESHOLD (UINT64_MAX / 100 * ENDLESS_MINE_PERCENT)
+
+//Seek that works with store files bigger than 2 GB
+static bool seekFile(FILE* file, uint64_t offset)
+{
+#if defined(WIN32) || defined(_WIN32)
+	return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+EndlessField::EndlessField() : seed(0), startRow(0), startColumn(0), started(false), exposed(false), flagCount(0), visibleCount(0), revision(0),
+	chunkBudget(ENDLESS_MIN_CHUNK_BUDGET), lastChunk(NULL), storeFile(NULL)
+{
+}
+
+EndlessField::~EndlessField()
+{
+	close();
+}
+
+bool EndlessField::reset(uint64_t seed, const std::string& storePath, size_t chunkBudget)
+{
+	this->seed = seed;
+	this->chunkBudget = std::max(chunkBudget, (size_t)ENDLESS_MIN_CHUNK_BUDGET);
+
+	started = false;
+	exposed = false;
+	flagCount = 0;
+	visibleCount = 0;
+	revision++;
+
+	chunks.clear();
+	chunkUsage.clear();
+	storedChunks.clear();
+	lastChunk = NULL;
+
+	//Stored chunks of previous field are useless
+	close();
+
+	this->storePath = storePath;
+	storeFile = fopen(storePath.c_str(), "w+b");
+
+	return storeFile != NULL;
+}
+
+void EndlessField::close()
+{
+	if (storeFile != NULL)
+	{
+		fclose(storeFile);
+		remove(storePath.c_str());
+		storeFile = NULL;
+	}
+}
+
+void EndlessField::start(int row, int column)
+{
+	startRow = row;
+	startColumn = column;
+	started = true;
+
+	//Chunks loaded before start have no mines yet
+	for (auto& entry : chunks)
+	{
+		generateChunk(*entry.second);
+	}
+
+	revision++;
+}
+
+bool EndlessField::prepareArea(int firstRow, int firstColumn, int lastRow, int lastColumn)
+{
+	if (lastRow <= firstRow || lastColumn <= firstColumn)
+	{
+		return true;
+	}
+
+	int firstChunkRow = firstRow >> CHUNK_SHIFT, lastChunkRow = (lastRow - 1) >> CHUNK_SHIFT;
+	int firstChunkColumn = firstColumn >> CHUNK_SHIFT, lastChunkColumn = (lastColumn - 1) >> CHUNK_SHIFT;
+
+	if ((size_t)(lastChunkRow - firstChunkRow + 1) * (lastChunkColumn - firstChunkColumn + 1) > chunkBudget)
+	{
+		return false;
+	}
+
+	for (int chunkRow = firstChunkRow; chunkRow <= lastChunkRow; chunkRow++)
+	{
+		for (int chunkColumn = firstChunkColumn; chunkColumn <= lastChunkColumn; chunkColumn++)
+		{
+			getChunk(chunkRow, chunkColumn);
+		}
+	}
+
+	return true;
+}
+
+void EndlessField::getRow(int row, int column, int count, FieldType* tiles) const
+{
+	while (count > 0)
+	{
+		int offset = column & (CHUNK_SIZE - 1);
+		int span = std::min(count, CHUNK_SIZE - offset);
+		const Chunk* chunk = findChunk(row >> CHUNK_SHIFT, column >> CHUNK_SHIFT);
+
+		if (chunk != NULL)
+		{
+			memcpy(tiles, chunk->tiles + ((row & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) + offset, span);
+
+			if (exposed)
+			{
+				for (int i = 0; i < span; i++)
+				{
+					if ((tiles[i] & FIELD_COUNT_MASK) == FIELD_MINE)
+					{
+						tiles[i] |= FIELD_VISIBLE;
+					}
+				}
+			}
+		}
+		else
+		{
+			memset(tiles, 0, span);
+		}
+
+		tiles += span;
+		column += span;
+		count -= span;
+	}
+}
+
+//Tiles waiting for uncovering are kept on own stack, chunks are loaded when uncovering reaches them
+bool EndlessField::uncover(int row, int column)
+{
+	if (isMine(row, column))
+	{
+		return false;
+	}
+
+	tileStack.clear();
+	tileStack.emplace_back(row, column);
+
+	while (!tileStack.empty())
+	{
+		int r = tileStack.back().first;
+		int c = tileStack.back().second;
+		tileStack.pop_back();
+
+		int tileIndex;
+		Chunk* chunk = getTileChunk(r, c, tileIndex);
+		FieldType& state = chunk->tiles[tileIndex];
+
+		//Skip tiles that are not hidden, with mine or with flag
+		if ((state & (FIELD_VISIBLE | FIELD_FLAG)) || (state & FIELD_COUNT_MASK) == FIELD_MINE)
+		{
+			continue;
+		}
+
+		state |= FIELD_VISIBLE;
+		chunk->changed = true;
+		visibleCount++;
+
+		//If field is count then continue after making it visible
+		if ((state & FIELD_COUNT_MASK) > 0)
+		{
+			continue;
+		}
+
+		for (int nr = r - 1; nr <= r + 1; nr++)
+		{
+			for (int nc = c - 1; nc <= c + 1; nc++)
+			{
+				if (nr != r || nc != c)
+				{
+					tileStack.emplace_back(nr, nc);
+				}
+			}
+		}
+	}
+
+	revision++;
+
+	return true;
+}
+
+void EndlessField::mark(int row, int column, bool marksEnabled)
+{
+	int tileIndex;
+	Chunk* chunk = getTileChunk(row, column, tileIndex);
+	FieldType& state = chunk->tiles[tileIndex];
+
+	//Can't mark visible fields
+	if (state & FIELD_VISIBLE)
+	{
+		return;
+	}
+
+	chunk->changed = true;
+	revision++;
+
+	if (state & FIELD_UNKNOWN)
+	{
+		state &= ~FIELD_UNKNOWN;
+		return;
+	}
+
+	if (!(state & FIELD_FLAG))
+	{
+		state |= FIELD_FLAG;
+		flagCount++;
+		return;
+	}
+
+	state &= ~FIELD_FLAG;
+	flagCount--;
+
+	if (marksEnabled)
+	{
+		state |= FIELD_UNKNOWN;
+	}
+}
+
+//Clicked state isn't stored, so it doesn't make chunk changed
+void EndlessField::setClicked(int row, int column, bool clicked)
+{
+	int tileIndex;
+	Chunk* chunk = getTileChunk(row, column, tileIndex);
+
+	if (clicked)
+	{
+		chunk->tiles[tileIndex] |= FIELD_CLICKED;
+	}
+	else
+	{
+		chunk->tiles[tileIndex] &= ~FIELD_CLICKED;
+	}
+
+	revision++;
+}
+
+bool EndlessField::isSelectable(int row, int column)
+{
+	int tileIndex;
+	Chunk* chunk = getTileChunk(row, column, tileIndex);
+
+	return !(chunk->tiles[tileIndex] & (FIELD_VISIBLE | FIELD_FLAG));
+}
+
+//Mines are made visible when tiles are read, chunks loaded later are exposed as well
+void EndlessField::expose()
+{
+	exposed = true;
+	revision++;
+}
+
+bool EndlessField::isMine(int row, int column) const
+{
+	if (!started || isStartArea(row, column))
+	{
+		return false;
+	}
+
+	return isMineInChunk(getChunkHash(row >> CHUNK_SHIFT, column >> CHUNK_SHIFT), ((row & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) | (column & (CHUNK_SIZE - 1)));
+}
+
+uint64_t EndlessField::getChunkHash(int chunkRow, int chunkColumn) const
+{
+	uint64_t state = seed + getChunkKey(chunkRow, chunkColumn) * 0x9E3779B97F4A7C15ull;
+
+	return Random::splitMix64(state);
+}
+
+//Every tile has own position in SplitMix64 sequence starting at hash of chunk coordinates
+bool EndlessField::isMineInChunk(uint64_t chunkHash, int tileIndex)
+{
+	uint64_t state = chunkHash + tileIndex;
+
+	return Random::splitMix64(state) < ENDLESS_MINE_THRESHOLD;
+}
+
+bool EndlessField::isStartArea(int row, int column) const
+{
+	return std::abs((int64_t)row - startRow) <= 1 && std::abs((int64_t)column - startColumn) <= 1;
+}
+
+EndlessField::Chunk* EndlessField::findChunk(int chunkRow, int chunkColumn) const
+{
+	auto found = chunks.find(getChunkKey(chunkRow, chunkColumn));
+
+	return (found != chunks.end()) ? found->second.get() : NULL;
+}
+
+EndlessField::Chunk* EndlessField::getChunk(int chunkRow, int chunkColumn)
+{
+	if (lastChunk != NULL && lastChunk->chunkRow == chunkRow && lastChunk->chunkColumn == chunkColumn)
+	{
+		return lastChunk;
+	}
+
+	uint64_t key = getChunkKey(chunkRow, chunkColumn);
+	auto found = chunks.find(key);
+
+	if (found != chunks.end())
+	{
+		lastChunk = found->second.get();
+		chunkUsage.splice(chunkUsage.begin(), chunkUsage, lastChunk->usage);
+
+		return lastChunk;
+	}
+
+	//Make room first so new chunk can't be dropped right away
+	trimChunks(chunkBudget - 1);
+
+	std::unique_ptr<Chunk> chunk;
+
+	if (!freeChunks.empty())
+	{
+		chunk = std::move(freeChunks.back());
+		freeChunks.pop_back();
+	}
+	else
+	{
+		chunk.reset(new Chunk());
+	}
+
+	chunk->chunkRow = chunkRow;
+	chunk->chunkColumn = chunkColumn;
+	chunk->changed = false;
+	memset(chunk->tiles, 0, sizeof(chunk->tiles));
+
+	generateChunk(*chunk);
+	loadStoredChunk(*chunk);
+
+	chunkUsage.push_front(key);
+	chunk->usage = chunkUsage.begin();
+	lastChunk = chunk.get();
+	chunks[key] = std::move(chunk);
+
+	return lastChunk;
+}
+
+//Mines around the chunk are needed for counts on its border, they are computed from hash without loading neighbour chunks
+void EndlessField::generateChunk(Chunk& chunk) const
+{
+	const int stride = CHUNK_SIZE + 2;
+	uint8_t mines[stride * stride] = {};
+	int firstRow = chunk.chunkRow * CHUNK_SIZE;
+	int firstColumn = chunk.chunkColumn * CHUNK_SIZE;
+
+	if (started)
+	{
+		uint64_t chunkHashes[3][3];
+
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				chunkHashes[i][j] = getChunkHash(chunk.chunkRow + i - 1, chunk.chunkColumn + j - 1);
+			}
+		}
+
+		//Row and column -1 and CHUNK_SIZE belong to neighbour chunks
+		for (int row = -1; row <= CHUNK_SIZE; row++)
+		{
+			const uint64_t* rowHashes = chunkHashes[(row < 0) ? 0 : (row < CHUNK_SIZE) ? 1 : 2];
+			int rowIndex = (row & (CHUNK_SIZE - 1)) << CHUNK_SHIFT;
+
+			for (int col = -1; col <= CHUNK_SIZE; col++)
+			{
+				uint64_t chunkHash = rowHashes[(col < 0) ? 0 : (col < CHUNK_SIZE) ? 1 : 2];
+				mines[(row + 1) * stride + col + 1] = isMineInChunk(chunkHash, rowIndex | (col & (CHUNK_SIZE - 1))) ? 1 : 0;
+			}
+		}
+
+		//Start area is cleared only if it's near this chunk
+		for (int row = startRow - 1; row <= startRow + 1; row++)
+		{
+			for (int col = startColumn - 1; col <= startColumn + 1; col++)
+			{
+				int64_t localRow = (int64_t)row - firstRow + 1, localColumn = (int64_t)col - firstColumn + 1;
+
+				if (localRow >= 0 && localRow < stride && localColumn >= 0 && localColumn < stride)
+				{
+					mines[localRow * stride + localColumn] = 0;
+				}
+			}
+		}
+	}
+
+	for (int row = 0; row < CHUNK_SIZE; row++)
+	{
+		for (int col = 0; col < CHUNK_SIZE; col++)
+		{
+			const uint8_t* above = mines + row * stride + col;
+			const uint8_t* current = above + stride;
+			const uint8_t* below = current + stride;
+			int count = current[1] ? FIELD_MINE : above[0] + above[1] + above[2] + current[0] + current[2] + below[0] + below[1] + below[2];
+
+			FieldType& state = chunk.tiles[(row << CHUNK_SHIFT) | col];
+			state = (state & ~FIELD_COUNT_MASK) | count;
+		}
+	}
+}
+
+bool EndlessField::storeChunk(const Chunk& chunk)
+{
+	if (storeFile == NULL)
+	{
+		return false;
+	}
+
+	StoredChunk record;
+	record.chunkRow = chunk.chunkRow;
+	record.chunkColumn = chunk.chunkColumn;
+
+	for (int row = 0; row < CHUNK_SIZE; row++)
+	{
+		uint64_t visibleBits = 0, flagBits = 0, unknownBits = 0;
+
+		for (int col = 0; col < CHUNK_SIZE; col++)
+		{
+			FieldType state = chunk.tiles[(row << CHUNK_SHIFT) | col];
+			uint64_t bit = (uint64_t)1 << col;
+
+			visibleBits |= (state & FIELD_VISIBLE) ? bit : 0;
+			flagBits |= (state & FIELD_FLAG) ? bit : 0;
+			unknownBits |= (state & FIELD_UNKNOWN) ? bit : 0;
+		}
+
+		record.planes[0][row] = visibleBits;
+		record.planes[1][row] = flagBits;
+		record.planes[2][row] = unknownBits;
+	}
+
+	//Chunk stored before is overwritten in place, so store grows only with number of changed chunks
+	uint64_t key = getChunkKey(chunk.chunkRow, chunk.chunkColumn);
+	auto found = storedChunks.find(key);
+	uint64_t offset = (found != storedChunks.end()) ? found->second : storedChunks.size() * sizeof(StoredChunk);
+
+	if (!seekFile(storeFile, offset) || fwrite(&record, sizeof(record), 1, storeFile) != 1)
+	{
+		return false;
+	}
+
+	storedChunks[key] = offset;
+
+	return true;
+}
+
+bool EndlessField::loadStoredChunk(Chunk& chunk)
+{
+	auto found = storedChunks.find(getChunkKey(chunk.chunkRow, chunk.chunkColumn));
+
+	if (found == storedChunks.end())
+	{
+		return false;
+	}
+
+	StoredChunk record;
+
+	if (!seekFile(storeFile, found->second) || fread(&record, sizeof(record), 1, storeFile) != 1)
+	{
+		return false;
+	}
+
+	for (int row = 0; row < CHUNK_SIZE; row++)
+	{
+		for (int col = 0; col < CHUNK_SIZE; col++)
+		{
+			FieldType& state = chunk.tiles[(row << CHUNK_SHIFT) | col];
+
+			state |= ((record.planes[0][row] >> col) & 1) ? FIELD_VISIBLE : 0;
+			state |= ((record.planes[1][row] >> col) & 1) ? FIELD_FLAG : 0;
+			state |= ((record.planes[2][row] >> col) & 1) ? FIELD_UNKNOWN : 0;
+		}
+	}
+
+	return true;
+}
+
+void EndlessField::trimChunks(size_t maxChunks)
+{
+	size_t attempts = chunks.size();
+
+	while (chunks.size() > maxChunks && attempts-- > 0)
+	{
+		auto found = chunks.find(chunkUsage.back());
+		Chunk* chunk = found->second.get();
+
+		//Chunk that can't be stored stays in memory, otherwise its state would be lost
+		if (chunk->changed && !storeChunk(*chunk))
+		{
+			chunkUsage.splice(chunkUsage.begin(), chunkUsage, chunk->usage);
+			continue;
+		}
+
+		if (chunk == lastChunk)
+		{
+			lastChunk = NULL;
+		}
+
+		chunkUsage.pop_back();
+		freeChunks.push_back(std::move(found->second));
+		chunks.erase(found);
+	}
+}
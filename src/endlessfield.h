@@ -0,0 +1,147 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "minefield.h"
+
+#define ENDLESS_MINE_PERCENT 18 //Chance of mine on every tile, low enough to keep openings finite
+#define ENDLESS_MIN_CHUNK_BUDGET 16
+
+//Endless mine field made of CHUNK_SIZE x CHUNK_SIZE chunks
+//Mines are derived from hash of seed and chunk coordinates (and tile position inside chunk), so chunk can be generated
+//at any time and in any order - only when view or uncovering first touches it
+//Resident chunks are limited by budget, least recently used chunk is dropped when budget is exceeded
+//Chunks changed by player are stored in chunk store file first (only state bitplanes, mines are generated again)
+//Tile coordinates can be negative, field is still limited by int range
+class EndlessField
+{
+public:
+	EndlessField();
+	~EndlessField();
+
+	//Start new field, store file is created (or truncated) at storePath
+	//Without store file changed chunks stay in memory
+	bool reset(uint64_t seed, const std::string& storePath, size_t chunkBudget);
+
+	//Close and remove store file
+	void close();
+
+	//Selected tile and its neighbours are always without mine, mines can't be known before that
+	void start(int row, int column);
+	bool isStarted() const { return started; }
+
+	//Load chunks covering tiles in rows [firstRow, lastRow) and columns [firstColumn, lastColumn)
+	//Returns false if they don't fit in chunk budget
+	bool prepareArea(int firstRow, int firstColumn, int lastRow, int lastColumn);
+
+	//Copy states of count tiles starting at (row, column), tiles of chunks that are not loaded are hidden
+	//Doesn't change anything, so it can be called from more threads at once (but not together with other methods)
+	void getRow(int row, int column, int count, FieldType* tiles) const;
+
+	FieldType getTile(int row, int column) const
+	{
+		FieldType state;
+		getRow(row, column, 1, &state);
+
+		return state;
+	}
+
+	//Same rules as Minefield
+	bool uncover(int row, int column);
+	void mark(int row, int column, bool marksEnabled);
+	void setClicked(int row, int column, bool clicked);
+	bool isSelectable(int row, int column);
+
+	//Show all mines after game over
+	void expose();
+
+	bool isMine(int row, int column) const;
+
+	//Flags placed on the field
+	int getFlagCount() const { return flagCount; }
+	int64_t getVisibleCount() const { return visibleCount; }
+	unsigned getRevision() const { return revision; }
+	size_t getResidentChunks() const { return chunks.size(); }
+	size_t getStoredChunks() const { return storedChunks.size(); }
+
+private:
+	struct Chunk
+	{
+		int chunkRow, chunkColumn;
+		bool changed; //Player changed some tile, chunk has to be stored before dropping it
+		std::list<uint64_t>::iterator usage;
+		FieldType tiles[CHUNK_TILES];
+	};
+
+	//Chunk record in store file - visible, flag and unknown bitplanes (one row of chunk per word)
+	struct StoredChunk
+	{
+		int32_t chunkRow, chunkColumn;
+		uint64_t planes[3][CHUNK_SIZE];
+	};
+
+	static uint64_t getChunkKey(int chunkRow, int chunkColumn) { return ((uint64_t)(uint32_t)chunkRow << 32) | (uint32_t)chunkColumn; }
+
+	Chunk* findChunk(int chunkRow, int chunkColumn) const;
+
+	//Find or load chunk, it becomes most recently used one
+	Chunk* getChunk(int chunkRow, int chunkColumn);
+
+	//Chunk of the tile, index of the tile in chunk is returned in tileIndex
+	Chunk* getTileChunk(int row, int column, int& tileIndex)
+	{
+		tileIndex = ((row & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) | (column & (CHUNK_SIZE - 1));
+
+		return getChunk(row >> CHUNK_SHIFT, column >> CHUNK_SHIFT);
+	}
+
+	uint64_t getChunkHash(int chunkRow, int chunkColumn) const;
+	static bool isMineInChunk(uint64_t chunkHash, int tileIndex);
+	bool isStartArea(int row, int column) const;
+
+	void generateChunk(Chunk& chunk) const;
+	bool storeChunk(const Chunk& chunk);
+	bool loadStoredChunk(Chunk& chunk);
+
+	//Drop least recently used chunks until at most maxChunks are left
+	void trimChunks(size_t maxChunks);
+
+	uint64_t seed;
+	int startRow, startColumn;
+	bool started, exposed;
+	int flagCount;
+	int64_t visibleCount;
+	unsigned revision;
+	size_t chunkBudget;
+
+	std::unordered_map<uint64_t, std::unique_ptr<Chunk>> chunks;
+	std::list<uint64_t> chunkUsage; //Most recently used chunk first
+	Chunk* lastChunk; //Most recently used chunk, checked before searching
+	std::vector<std::unique_ptr<Chunk>> freeChunks; //Dropped chunks reused for loading
+
+	FILE* storeFile;
+	std::string storePath;
+	std::unordered_map<uint64_t, uint64_t> storedChunks; //Chunk key to record offset in store file
+
+	std::vector<std::pair<int, int>> tileStack;
+};
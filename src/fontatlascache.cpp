@@ -0,0 +1,223 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "fontatlascache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#define FONT_ATLAS_CACHE_MAGIC 0x46445344 //"DSDF"
+#define FONT_ATLAS_CACHE_VERSION 1
+
+//File starts with header, followed by glyphs, custom rectangles and RGBA pixels
+struct FontAtlasCacheHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int imguiVersion;
+	unsigned int glyphSize; //sizeof(ImFontGlyph) - layout of stored glyphs
+	float fontSize;
+	float ascent, descent;
+	int metricsTotalSurface;
+	int glyphCount;
+	int customRectCount;
+	int packIdMouseCursors, packIdLines;
+	int texWidth, texHeight;
+	ImVec2 texUvScale;
+	ImVec2 texUvWhitePixel;
+	ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+};
+
+//Custom rectangle without font pointer
+struct FontAtlasCacheRect
+{
+	unsigned short x, y, width, height;
+};
+
+bool loadFontAtlasCache(const std::string& path, ImFontAtlas* atlas, ImFont* font)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	//Whole file is read at once
+	std::vector<unsigned char> data;
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	if (fileSize > (long)sizeof(FontAtlasCacheHeader))
+	{
+		data.resize(fileSize);
+
+		if (fread(data.data(), 1, data.size(), file) != data.size())
+		{
+			data.clear();
+		}
+	}
+
+	fclose(file);
+
+	if (data.empty())
+	{
+		return false;
+	}
+
+	FontAtlasCacheHeader header;
+	memcpy(&header, data.data(), sizeof(header));
+
+	if (header.magic != FONT_ATLAS_CACHE_MAGIC || header.version != FONT_ATLAS_CACHE_VERSION || header.imguiVersion != IMGUI_VERSION_NUM
+		|| header.glyphSize != sizeof(ImFontGlyph) || header.fontSize != font->ConfigData->SizePixels
+		|| header.glyphCount <= 0 || header.customRectCount < 0 || header.texWidth <= 0 || header.texHeight <= 0)
+	{
+		return false;
+	}
+
+	size_t glyphsSize = (size_t)header.glyphCount * sizeof(ImFontGlyph);
+	size_t rectsSize = (size_t)header.customRectCount * sizeof(FontAtlasCacheRect);
+	size_t pixelsSize = (size_t)header.texWidth * header.texHeight * 4;
+
+	if (data.size() != sizeof(header) + glyphsSize + rectsSize + pixelsSize)
+	{
+		return false;
+	}
+
+	const unsigned char* glyphs = data.data() + sizeof(header);
+	const unsigned char* rects = glyphs + glyphsSize;
+	const unsigned char* pixels = rects + rectsSize;
+
+	//Font data normally produced by ImFontAtlasBuildSetupFont() and AddGlyph()
+	font->ClearOutputData();
+	font->FontSize = header.fontSize;
+	font->Ascent = header.ascent;
+	font->Descent = header.descent;
+	font->MetricsTotalSurface = header.metricsTotalSurface;
+	font->ContainerAtlas = atlas;
+	font->Glyphs.resize(header.glyphCount);
+	memcpy(font->Glyphs.Data, glyphs, glyphsSize);
+
+	atlas->CustomRects.resize(header.customRectCount);
+
+	for (int i = 0; i < header.customRectCount; i++)
+	{
+		FontAtlasCacheRect rect;
+		memcpy(&rect, rects + i * sizeof(FontAtlasCacheRect), sizeof(rect));
+
+		atlas->CustomRects[i] = ImFontAtlasCustomRect();
+		atlas->CustomRects[i].X = rect.x;
+		atlas->CustomRects[i].Y = rect.y;
+		atlas->CustomRects[i].Width = rect.width;
+		atlas->CustomRects[i].Height = rect.height;
+	}
+
+	atlas->PackIdMouseCursors = header.packIdMouseCursors;
+	atlas->PackIdLines = header.packIdLines;
+	atlas->TexWidth = header.texWidth;
+	atlas->TexHeight = header.texHeight;
+	atlas->TexUvScale = header.texUvScale;
+	atlas->TexUvWhitePixel = header.texUvWhitePixel;
+	memcpy(atlas->TexUvLines, header.texUvLines, sizeof(atlas->TexUvLines));
+
+	atlas->ClearTexData();
+	atlas->TexPixelsRGBA32 = (unsigned int*)IM_ALLOC(pixelsSize);
+	memcpy(atlas->TexPixelsRGBA32, pixels, pixelsSize);
+	atlas->TexPixelsUseColors = false;
+
+	font->BuildLookupTable();
+	atlas->TexReady = true;
+
+	return true;
+}
+
+bool saveFontAtlasCache(const std::string& path, ImFontAtlas* atlas, ImFont* font)
+{
+	unsigned char* pixels;
+	int width, height;
+	atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+	if (pixels == NULL || atlas->Fonts.Size != 1)
+	{
+		return false;
+	}
+
+	//Custom glyphs point to fonts so they can't be stored
+	for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+	{
+		if (rect.Font != NULL)
+		{
+			return false;
+		}
+	}
+
+	FontAtlasCacheHeader header;
+	memset((void*)&header, 0, sizeof(header));
+	header.magic = FONT_ATLAS_CACHE_MAGIC;
+	header.version = FONT_ATLAS_CACHE_VERSION;
+	header.imguiVersion = IMGUI_VERSION_NUM;
+	header.glyphSize = sizeof(ImFontGlyph);
+	header.fontSize = font->FontSize;
+	header.ascent = font->Ascent;
+	header.descent = font->Descent;
+	header.metricsTotalSurface = font->MetricsTotalSurface;
+	header.glyphCount = font->Glyphs.Size;
+	header.customRectCount = atlas->CustomRects.Size;
+	header.packIdMouseCursors = atlas->PackIdMouseCursors;
+	header.packIdLines = atlas->PackIdLines;
+	header.texWidth = width;
+	header.texHeight = height;
+	header.texUvScale = atlas->TexUvScale;
+	header.texUvWhitePixel = atlas->TexUvWhitePixel;
+	memcpy(header.texUvLines, atlas->TexUvLines, sizeof(header.texUvLines));
+
+	//Write to temporary file first so interrupted write never leaves broken cache
+	std::string temporaryPath = path + ".tmp";
+	FILE* file = fopen(temporaryPath.c_str(), "wb");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(font->Glyphs.Data, sizeof(ImFontGlyph), font->Glyphs.Size, file) == (size_t)font->Glyphs.Size;
+
+	for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+	{
+		FontAtlasCacheRect cacheRect = { rect.X, rect.Y, rect.Width, rect.Height };
+		written = written && fwrite(&cacheRect, sizeof(cacheRect), 1, file) == 1;
+	}
+
+	written = written && fwrite(pixels, (size_t)width * height * 4, 1, file) == 1;
+	written = (fclose(file) == 0) && written;
+
+	std::error_code errorCode;
+
+	if (written)
+	{
+		std::filesystem::rename(temporaryPath, path, errorCode);
+	}
+
+	if (!written || errorCode)
+	{
+		std::filesystem::remove(temporaryPath, errorCode);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,29 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "imgui.h"
+
+//Cache of baked ImGui font atlas - RGBA texture together with glyph and custom rectangle data
+//Atlas with single font (added but not built yet) can be restored from cache without rasterizing glyphs
+//Cache is only valid for the same Dear ImGui version and font size
+
+//Restore built state of atlas and font from cache file, returns false if file is missing or doesn't match
+bool loadFontAtlasCache(const std::string& path, ImFontAtlas* atlas, ImFont* font);
+
+//Store built atlas and font in cache file
+bool saveFontAtlasCache(const std::string& path, ImFontAtlas* atlas, ImFont* font);
@@ -0,0 +1,166 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gamehistory.h"
+#include "mappedfile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#define GAME_HISTORY_MAGIC 0x48445344 //"DSDH"
+#define GAME_HISTORY_VERSION 1
+
+//File starts with header, followed by records
+struct GameHistoryHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t recordSize;
+	uint32_t reserved;
+};
+
+GameHistory::GameHistory() : valid(false), headerWritten(false), recordCount(0)
+{
+	memset(statistics, 0, sizeof(statistics));
+}
+
+bool GameHistory::open(const std::string& path)
+{
+	this->path = path;
+	valid = false;
+	headerWritten = false;
+	recordCount = 0;
+	memset(statistics, 0, sizeof(statistics));
+
+	MappedFile file;
+
+	if (!file.open(path)) //No history yet
+	{
+		valid = !std::filesystem::exists(path);
+		return valid;
+	}
+
+	if (file.getSize() < sizeof(GameHistoryHeader))
+	{
+		//Empty file (or interrupted header write) - start over
+		file.close();
+
+		std::error_code errorCode;
+		std::filesystem::resize_file(path, 0, errorCode);
+
+		valid = !errorCode;
+		return valid;
+	}
+
+	GameHistoryHeader header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	if (header.magic != GAME_HISTORY_MAGIC || header.version != GAME_HISTORY_VERSION || header.recordSize != sizeof(GameRecord))
+	{
+		return false;
+	}
+
+	size_t dataSize = file.getSize() - sizeof(header);
+	recordCount = dataSize / sizeof(GameRecord);
+
+	const unsigned char* records = file.getData() + sizeof(header);
+
+	for (uint64_t i = 0; i < recordCount; i++)
+	{
+		GameRecord record;
+		memcpy(&record, records + i * sizeof(GameRecord), sizeof(record));
+
+		addToStatistics(record);
+	}
+
+	file.close();
+
+	//Drop partial record left by interrupted write, otherwise all following records would be misaligned
+	if (dataSize % sizeof(GameRecord) != 0)
+	{
+		std::error_code errorCode;
+		std::filesystem::resize_file(path, sizeof(header) + recordCount * sizeof(GameRecord), errorCode);
+
+		if (errorCode)
+		{
+			return false;
+		}
+	}
+
+	valid = true;
+	headerWritten = true;
+
+	return true;
+}
+
+bool GameHistory::append(const GameRecord& record)
+{
+	if (!valid)
+	{
+		return false;
+	}
+
+	FILE* file = fopen(path.c_str(), "ab");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool written = true;
+
+	if (!headerWritten)
+	{
+		GameHistoryHeader header = { GAME_HISTORY_MAGIC, GAME_HISTORY_VERSION, sizeof(GameRecord), 0 };
+		written = fwrite(&header, sizeof(header), 1, file) == 1;
+		headerWritten = written;
+	}
+
+	written = written && fwrite(&record, sizeof(record), 1, file) == 1;
+	written = (fclose(file) == 0) && written;
+
+	if (!written)
+	{
+		return false;
+	}
+
+	recordCount++;
+	addToStatistics(record);
+
+	return true;
+}
+
+void GameHistory::addToStatistics(const GameRecord& record)
+{
+	if (record.mode >= MODE_COUNT)
+	{
+		return;
+	}
+
+	GameStatistics& modeStatistics = statistics[record.mode];
+	modeStatistics.played++;
+
+	if (record.result == RESULT_WON)
+	{
+		modeStatistics.won++;
+		modeStatistics.wonTimeSum += record.time;
+		modeStatistics.bvSum += record.bv;
+
+		if (modeStatistics.bestTime == 0 || record.time < modeStatistics.bestTime)
+		{
+			modeStatistics.bestTime = record.time;
+		}
+	}
+}
@@ -0,0 +1,72 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+enum GameResult { RESULT_LOST, RESULT_WON };
+
+//Fixed size record of one finished game
+struct GameRecord
+{
+	uint64_t seed;
+	uint32_t width, height, mines;
+	uint32_t time; //Game time in milliseconds
+	uint32_t clicks; //Uncover and mark clicks
+	uint32_t bv; //3BV of the field - minimal number of clicks needed to clear it
+	uint8_t mode; //GameMode
+	uint8_t result; //GameResult
+	uint8_t reserved[6];
+};
+
+static_assert(sizeof(GameRecord) == 40, "Game record size is part of history file format");
+
+//Summary of games played in one mode
+struct GameStatistics
+{
+	int played, won;
+	uint32_t bestTime; //Milliseconds, 0 if no game was won
+	uint64_t wonTimeSum;
+	uint64_t bvSum; //3BV of won games, used for average 3BV/s
+};
+
+//Append only log of finished games stored in binary file
+//Records are only appended so saving game is a single small write and reading whole log is just mapping the file
+class GameHistory
+{
+public:
+	static const int MODE_COUNT = 4;
+
+	GameHistory();
+
+	//Map existing log and compute statistics, creates nothing until first record is appended
+	//Returns false if file exists but isn't valid history log (it's left untouched then)
+	bool open(const std::string& path);
+
+	bool append(const GameRecord& record);
+
+	uint64_t getRecordCount() const { return recordCount; }
+	const GameStatistics& getStatistics(int mode) const { return statistics[mode]; }
+
+private:
+	void addToStatistics(const GameRecord& record);
+
+	std::string path;
+	bool valid;
+	bool headerWritten;
+	uint64_t recordCount;
+	GameStatistics statistics[MODE_COUNT];
+};
@@ -144,6 +144,8 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
 
     // Setup desired state
     ImGui_ImplSDLRenderer2_SetupRenderState(renderer);
+    SDL_Rect setup_viewport;
+    SDL_RenderGetViewport(renderer, &setup_viewport);
 
     // Setup render state structure (for callbacks and custom texture bindings)
     ImGuiPlatformIO& platform_io = ImGui::GetPlatformIO();
@@ -155,6 +157,12 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
 	ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
 	ImVec2 clip_scale = render_scale;
 
+    // Last clip rectangle sent to SDL, so unchanged rectangles are not submitted again.
+    // Invalidated whenever something outside of this loop (callbacks, state reset) may have touched it.
+    SDL_Rect last_clip = {};
+    bool last_clip_valid = false;
+    bool callbacks_called = false;
+
     // Render command lists
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
@@ -173,9 +181,24 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
                     ImGui_ImplSDLRenderer2_SetupRenderState(renderer);
                 else
                     pcmd->UserCallback(draw_list, pcmd);
+                last_clip_valid = false;
+                callbacks_called = true;
             }
             else
             {
+                // Merge following commands that share texture, clip rect and vertex offset and whose indices are contiguous,
+                // so they can be submitted with a single SDL_RenderGeometryRaw() call.
+                unsigned int elem_count = pcmd->ElemCount;
+                while (cmd_i + 1 < draw_list->CmdBuffer.Size)
+                {
+                    const ImDrawCmd* next_cmd = &draw_list->CmdBuffer[cmd_i + 1];
+                    if (next_cmd->UserCallback != nullptr || next_cmd->GetTexID() != pcmd->GetTexID() || next_cmd->VtxOffset != pcmd->VtxOffset ||
+                        next_cmd->IdxOffset != pcmd->IdxOffset + elem_count || memcmp(&next_cmd->ClipRect, &pcmd->ClipRect, sizeof(ImVec4)) != 0)
+                        break;
+                    elem_count += next_cmd->ElemCount;
+                    cmd_i++;
+                }
+
                 // Project scissor/clipping rectangles into framebuffer space
                 ImVec2 clip_min((pcmd->ClipRect.x - clip_off.x) * clip_scale.x, (pcmd->ClipRect.y - clip_off.y) * clip_scale.y);
                 ImVec2 clip_max((pcmd->ClipRect.z - clip_off.x) * clip_scale.x, (pcmd->ClipRect.w - clip_off.y) * clip_scale.y);
@@ -187,7 +210,12 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
                     continue;
 
                 SDL_Rect r = { (int)(clip_min.x), (int)(clip_min.y), (int)(clip_max.x - clip_min.x), (int)(clip_max.y - clip_min.y) };
-                SDL_RenderSetClipRect(renderer, &r);
+                if (!last_clip_valid || memcmp(&r, &last_clip, sizeof(SDL_Rect)) != 0)
+                {
+                    SDL_RenderSetClipRect(renderer, &r);
+                    last_clip = r;
+                    last_clip_valid = true;
+                }
 
                 const float* xy = (const float*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, pos));
                 const float* uv = (const float*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, uv));
@@ -204,15 +232,20 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
                     color, (int)sizeof(ImDrawVert),
                     uv, (int)sizeof(ImDrawVert),
                     draw_list->VtxBuffer.Size - pcmd->VtxOffset,
-                    idx_buffer + pcmd->IdxOffset, pcmd->ElemCount, sizeof(ImDrawIdx));
+                    idx_buffer + pcmd->IdxOffset, elem_count, sizeof(ImDrawIdx));
             }
         }
     }
     platform_io.Renderer_RenderState = nullptr;
 
     // Restore modified SDL_Renderer state
-    SDL_RenderSetViewport(renderer, &old.Viewport);
-    SDL_RenderSetClipRect(renderer, old.ClipEnabled ? &old.ClipRect : nullptr);
+    // (Viewport usually already covered the whole output, skip restoring it when nothing could have changed it)
+    if (callbacks_called || memcmp(&old.Viewport, &setup_viewport, sizeof(SDL_Rect)) != 0)
+        SDL_RenderSetViewport(renderer, &old.Viewport);
+    if (!old.ClipEnabled)
+        SDL_RenderSetClipRect(renderer, nullptr);
+    else if (!last_clip_valid || memcmp(&old.ClipRect, &last_clip, sizeof(SDL_Rect)) != 0)
+        SDL_RenderSetClipRect(renderer, &old.ClipRect);
 }
 
 // Called by Init/NewFrame/Shutdown
@@ -0,0 +1,116 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "latencyhistogram.h"
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::addSample(double milliseconds)
+{
+	int bucket = (int)(milliseconds / BUCKET_WIDTH);
+
+	if (bucket < 0)
+	{
+		bucket = 0;
+	}
+
+	if (bucket >= BUCKET_COUNT)
+	{
+		bucket = BUCKET_COUNT - 1;
+	}
+
+	buckets[bucket]++;
+
+	if (sampleCount == 0 || milliseconds < minSample)
+	{
+		minSample = milliseconds;
+	}
+
+	if (milliseconds > maxSample)
+	{
+		maxSample = milliseconds;
+	}
+
+	sampleSum += milliseconds;
+	sampleCount++;
+}
+
+void LatencyHistogram::reset()
+{
+	for (int i = 0; i < BUCKET_COUNT; i++)
+	{
+		buckets[i] = 0;
+	}
+
+	sampleCount = 0;
+	sampleSum = 0.0;
+	minSample = 0.0;
+	maxSample = 0.0;
+}
+
+double LatencyHistogram::getPercentile(double percentile) const
+{
+	if (sampleCount == 0)
+	{
+		return 0.0;
+	}
+
+	double wanted = sampleCount * percentile / 100.0;
+	int counted = 0;
+
+	for (int i = 0; i < BUCKET_COUNT - 1; i++)
+	{
+		counted += buckets[i];
+
+		if (counted >= wanted)
+		{
+			return (i + 1) * BUCKET_WIDTH;
+		}
+	}
+
+	return maxSample;
+}
+
+void LatencyHistogram::print(FILE* file) const
+{
+	fprintf(file, "Input to present latency: %d samples\n", sampleCount);
+
+	if (sampleCount == 0)
+	{
+		return;
+	}
+
+	fprintf(file, "min %.2f ms, mean %.2f ms, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.2f ms\n",
+		getMin(), getMean(), getPercentile(50), getPercentile(95), getPercentile(99), getMax());
+
+	for (int i = 0; i < BUCKET_COUNT; i++)
+	{
+		if (buckets[i] == 0)
+		{
+			continue;
+		}
+
+		if (i < BUCKET_COUNT - 1)
+		{
+			fprintf(file, "%5.1f - %5.1f ms: %d\n", i * BUCKET_WIDTH, (i + 1) * BUCKET_WIDTH, buckets[i]);
+		}
+		else
+		{
+			fprintf(file, "%5.1f ms and more: %d\n", i * BUCKET_WIDTH, buckets[i]);
+		}
+	}
+}
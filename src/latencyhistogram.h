@@ -0,0 +1,48 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdio>
+
+//Histogram of latencies (in milliseconds) with fixed width buckets
+//Last bucket collects all samples that don't fit in previous ones
+class LatencyHistogram
+{
+public:
+	static const int BUCKET_COUNT = 100;
+	static constexpr double BUCKET_WIDTH = 0.5;
+
+	LatencyHistogram();
+
+	void addSample(double milliseconds);
+	void reset();
+
+	int getSampleCount() const { return sampleCount; }
+	int getBucket(int index) const { return buckets[index]; }
+	double getMin() const { return sampleCount > 0 ? minSample : 0.0; }
+	double getMax() const { return maxSample; }
+	double getMean() const { return sampleCount > 0 ? sampleSum / sampleCount : 0.0; }
+
+	//Get approximate percentile (0-100) - upper bound of bucket containing it
+	double getPercentile(double percentile) const;
+
+	//Print summary and all non empty buckets
+	void print(FILE* file) const;
+
+private:
+	int buckets[BUCKET_COUNT];
+	int sampleCount;
+	double sampleSum, minSample, maxSample;
+};
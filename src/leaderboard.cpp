@@ -0,0 +1,275 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "leaderboard.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+#include "mappedfile.h"
+
+#define LEADERBOARD_MAGIC 0x4C445344 //"DSDL"
+#define LEADERBOARD_VERSION 2
+
+struct LeaderboardHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t recordSize;
+};
+
+Leaderboard::Leaderboard() : file(NULL), valid(false)
+{
+}
+
+Leaderboard::~Leaderboard()
+{
+	closeFile();
+}
+
+//Only keys of records are read to build index, record itself is read when board is shown
+bool Leaderboard::open(const std::string& path)
+{
+	closeFile();
+	boardIndex.clear();
+
+	this->path = path;
+	valid = false;
+
+	if (!std::filesystem::exists(path))
+	{
+		valid = true;
+
+		return true;
+	}
+
+	MappedFile mapping;
+
+	if (!mapping.open(path) || mapping.getSize() < sizeof(LeaderboardHeader))
+	{
+		return false;
+	}
+
+	LeaderboardHeader header;
+	memcpy(&header, mapping.getData(), sizeof(header));
+
+	if (header.magic != LEADERBOARD_MAGIC || header.version != LEADERBOARD_VERSION || header.recordSize != sizeof(LeaderboardRecord))
+	{
+		return false;
+	}
+
+	//Partially written record at the end is ignored and overwritten by next new board
+	size_t recordCount = (mapping.getSize() - sizeof(header)) / sizeof(LeaderboardRecord);
+	boardIndex.resize(recordCount);
+
+	for (size_t i = 0; i < recordCount; i++)
+	{
+		const unsigned char* record = mapping.getData() + sizeof(header) + i * sizeof(LeaderboardRecord);
+		uint16_t width, height;
+		uint32_t mines;
+
+		memcpy(&width, record + offsetof(LeaderboardRecord, width), sizeof(width));
+		memcpy(&height, record + offsetof(LeaderboardRecord, height), sizeof(height));
+		memcpy(&mines, record + offsetof(LeaderboardRecord, mines), sizeof(mines));
+
+		boardIndex[i].key = getKey(width, height, mines);
+		boardIndex[i].record = (uint32_t)i;
+	}
+
+	std::sort(boardIndex.begin(), boardIndex.end(), [](const IndexEntry& a, const IndexEntry& b)
+	{
+		return a.key < b.key;
+	});
+
+	mapping.close();
+	file = fopen(path.c_str(), "r+b");
+
+	if (file == NULL)
+	{
+		boardIndex.clear();
+		return false;
+	}
+
+	valid = true;
+
+	return true;
+}
+
+LeaderboardRecord Leaderboard::getBoard(int index) const
+{
+	LeaderboardRecord record;
+
+	if (!readRecord(boardIndex[index].record, record))
+	{
+		uint64_t key = boardIndex[index].key;
+
+		memset(&record, 0, sizeof(record));
+		record.width = (uint16_t)(key >> 48);
+		record.height = (uint16_t)(key >> 32);
+		record.mines = (uint32_t)key;
+	}
+
+	return record;
+}
+
+int Leaderboard::findBoard(int width, int height, int mines) const
+{
+	uint64_t key = getKey(width, height, mines);
+	auto found = lowerBound(key);
+
+	if (found != boardIndex.end() && found->key == key)
+	{
+		return (int)(found - boardIndex.begin());
+	}
+
+	return -1;
+}
+
+bool Leaderboard::isBestTime(int width, int height, int mines, uint32_t time) const
+{
+	if (!valid)
+	{
+		return false;
+	}
+
+	int index = findBoard(width, height, mines);
+
+	if (index < 0)
+	{
+		return true;
+	}
+
+	LeaderboardRecord record = getBoard(index);
+
+	return record.timeCount < TIMES_PER_BOARD || time < record.times[TIMES_PER_BOARD - 1].time;
+}
+
+bool Leaderboard::insert(int width, int height, int mines, uint32_t time, const std::string& name)
+{
+	if (!valid || !isBestTime(width, height, mines, time))
+	{
+		return false;
+	}
+
+	uint64_t key = getKey(width, height, mines);
+	auto position = lowerBound(key);
+	bool newBoard = position == boardIndex.end() || position->key != key;
+	uint32_t recordNumber = newBoard ? (uint32_t)boardIndex.size() : position->record;
+	LeaderboardRecord record;
+
+	if (newBoard || !readRecord(recordNumber, record))
+	{
+		memset(&record, 0, sizeof(record));
+		record.width = width;
+		record.height = height;
+		record.mines = mines;
+	}
+
+	record.timeCount = std::min(record.timeCount, (uint32_t)TIMES_PER_BOARD);
+
+	//Move slower times one slot down, the slowest one falls off when board is full
+	int slot = std::min((int)record.timeCount, TIMES_PER_BOARD - 1);
+
+	while (slot > 0 && time < record.times[slot - 1].time)
+	{
+		record.times[slot] = record.times[slot - 1];
+		slot--;
+	}
+
+	record.times[slot].time = time;
+	memset(record.times[slot].name, 0, NAME_SIZE);
+	strncpy(record.times[slot].name, name.c_str(), NAME_SIZE - 1);
+	record.timeCount = std::min(record.timeCount + 1, (uint32_t)TIMES_PER_BOARD);
+
+	if (!writeRecord(recordNumber, record))
+	{
+		return false;
+	}
+
+	if (newBoard)
+	{
+		boardIndex.insert(position, { key, recordNumber });
+	}
+
+	return true;
+}
+
+bool Leaderboard::clear()
+{
+	closeFile();
+	boardIndex.clear();
+
+	std::error_code errorCode;
+	std::filesystem::remove(path, errorCode);
+
+	//Unreadable file is replaced by new one
+	valid = !errorCode;
+
+	return valid;
+}
+
+uint64_t Leaderboard::getKey(int width, int height, int mines)
+{
+	return ((uint64_t)(uint16_t)width << 48) | ((uint64_t)(uint16_t)height << 32) | (uint32_t)mines;
+}
+
+std::vector<Leaderboard::IndexEntry>::const_iterator Leaderboard::lowerBound(uint64_t key) const
+{
+	return std::lower_bound(boardIndex.begin(), boardIndex.end(), key, [](const IndexEntry& entry, uint64_t key)
+	{
+		return entry.key < key;
+	});
+}
+
+bool Leaderboard::readRecord(uint32_t record, LeaderboardRecord& data) const
+{
+	return file != NULL && fseek(file, (long)(sizeof(LeaderboardHeader) + (size_t)record * sizeof(LeaderboardRecord)), SEEK_SET) == 0
+		&& fread(&data, sizeof(data), 1, file) == 1;
+}
+
+//Write record in place (or append it if it's past the end), file is created with the first record
+bool Leaderboard::writeRecord(uint32_t record, const LeaderboardRecord& data)
+{
+	if (file == NULL)
+	{
+		file = fopen(path.c_str(), "w+b");
+
+		if (file == NULL)
+		{
+			return false;
+		}
+
+		LeaderboardHeader header = { LEADERBOARD_MAGIC, LEADERBOARD_VERSION, sizeof(LeaderboardRecord) };
+
+		if (fwrite(&header, sizeof(header), 1, file) != 1)
+		{
+			closeFile();
+			return false;
+		}
+	}
+
+	return fseek(file, (long)(sizeof(LeaderboardHeader) + (size_t)record * sizeof(LeaderboardRecord)), SEEK_SET) == 0
+		&& fwrite(&data, sizeof(data), 1, file) == 1 && fflush(file) == 0;
+}
+
+void Leaderboard::closeFile()
+{
+	if (file != NULL)
+	{
+		fclose(file);
+		file = NULL;
+	}
+}
@@ -0,0 +1,89 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//Best times of one custom board, sorted from the fastest
+struct LeaderboardRecord
+{
+	uint16_t width, height;
+	uint32_t mines;
+	uint32_t timeCount; //Number of used slots in times
+
+	struct
+	{
+		uint32_t time; //Milliseconds
+		char name[16];
+	} times[10];
+};
+
+static_assert(sizeof(LeaderboardRecord) == 212, "Leaderboard record size is part of leaderboard file format");
+
+//Best times of custom boards keyed by width, height and mines
+//File holds fixed size records in order they were added, record is only appended or rewritten in place
+//Sorted index of keys is built from the file on open and kept sorted by insertion, so lookup and insert
+//are binary searches that read or write single record
+class Leaderboard
+{
+public:
+	static const int TIMES_PER_BOARD = 10;
+	static const int NAME_SIZE = 16;
+
+	Leaderboard();
+	~Leaderboard();
+
+	Leaderboard(const Leaderboard&) = delete;
+	Leaderboard& operator=(const Leaderboard&) = delete;
+
+	bool open(const std::string& path);
+
+	int getBoardCount() const { return (int)boardIndex.size(); }
+
+	//Record of board with given index (boards are sorted by key)
+	LeaderboardRecord getBoard(int index) const;
+
+	//Find index of board, returns -1 if there are no times for it
+	int findBoard(int width, int height, int mines) const;
+
+	//Check if time would get on the board
+	bool isBestTime(int width, int height, int mines, uint32_t time) const;
+
+	bool insert(int width, int height, int mines, uint32_t time, const std::string& name);
+
+	//Remove all boards
+	bool clear();
+
+private:
+	struct IndexEntry
+	{
+		uint64_t key;
+		uint32_t record; //Position of record in file
+	};
+
+	static uint64_t getKey(int width, int height, int mines);
+	std::vector<IndexEntry>::const_iterator lowerBound(uint64_t key) const;
+	bool readRecord(uint32_t record, LeaderboardRecord& data) const;
+	bool writeRecord(uint32_t record, const LeaderboardRecord& data);
+	void closeFile();
+
+	std::string path;
+	FILE* file;
+	bool valid;
+	std::vector<IndexEntry> boardIndex;
+};
@@ -0,0 +1,809 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "minefield.h"
+#include "random.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define PARALLEL_GENERATE_TILES (1 << 20) //Fields with at least that many tiles are generated in bands (that gives different mines than generating tile by tile)
+#define GENERATE_BAND_ROWS CHUNK_SIZE //Rows of tiles processed by one job when generating field
+#define GENERATE_BUCKET_BITS 12 //Tile keys are counted in 2^GENERATE_BUCKET_BITS buckets by their top bits
+
+//Random key of the tile - tile index is position in SplitMix64 sequence, so any tile can be computed independently
+static uint64_t getTileKey(uint64_t seed, uint64_t tileIndex)
+{
+	uint64_t state = seed + tileIndex * 0x9E3779B97F4A7C15ull;
+
+	return Random::splitMix64(state);
+}
+
+Minefield::Minefield() : width(0), height(0), mines(0), flagCount(0), rowWords(0), chunkColumns(0), undoLimit(0), visibleCount(0), exploded(false), exposed(false),
+	revision(0), chunkArena(CHUNK_TILES), generatedBands(0), stepNumber(0)
+{
+}
+
+void Minefield::reset(int width, int height, int mines)
+{
+	this->width = width;
+	this->height = height;
+	this->mines = mines;
+
+	flagCount = mines;
+	visibleCount = 0;
+	exploded = false;
+	exposed = false;
+
+	generatedBands = 0;
+
+	rowWords = (width + 63) / 64;
+	mineBits.assign((size_t)rowWords * height, 0);
+	adviseHugePages(mineBits.data(), mineBits.size() * sizeof(uint64_t));
+
+	//Chunks on right and bottom edge are only partially used
+	chunkColumns = (width + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+	size_t chunkCount = (size_t)chunkColumns * ((height + CHUNK_SIZE - 1) >> CHUNK_SHIFT);
+	stateChunks.clear();
+	stateChunks.resize(chunkCount);
+
+	//File is created again only when field size changes, chunks overwrite their place when they are created
+	if (pagedStoragePath.empty())
+	{
+		pagedStorage.close();
+	}
+	else if (pagedStorage.getSize() != chunkCount * CHUNK_TILES)
+	{
+		pagedStorage.create(pagedStoragePath, chunkCount * CHUNK_TILES);
+	}
+
+	chunkRevisions.assign(chunkCount, revision);
+	revision++;
+
+	chunkSteps.resize(chunkCount);
+	clearSteps();
+}
+
+void Minefield::generate(uint64_t seed, int selectedRow, int selectedColumn, ThreadPool* threadPool)
+{
+	//Copies made before generation have no mine counts, generation itself can't be undone
+	clearSteps();
+
+	if ((int64_t)width * height >= PARALLEL_GENERATE_TILES)
+	{
+		generateInBands(seed, selectedRow, selectedColumn, threadPool);
+
+		//Bits of neighbour bands are complete now, so counts of their border tiles can be computed
+		ThreadPool::forEachBand(threadPool, height, CHUNK_SIZE, [this](int, int firstRow, int lastRow)
+		{
+			countMines(firstRow, lastRow);
+		});
+
+		revision++;
+
+		return;
+	}
+
+	Random random(seed);
+
+	//Setup mines
+	int mineRow = random.nextBounded(height);
+	int mineColumn = random.nextBounded(width);
+
+	for (int i = 0; i < mines; i++)
+	{
+		//Keep getting random number as long we dont get empty tile
+		//Also don't set mine on selected field
+		while ((mineRow == selectedRow && mineColumn == selectedColumn) || isMine(mineRow, mineColumn))
+		{
+			mineRow = random.nextBounded(height);
+			mineColumn = random.nextBounded(width);
+		}
+
+		//Set mine on selected field
+		mineBits[(size_t)mineRow * rowWords + (mineColumn >> 6)] |= (uint64_t)1 << (mineColumn & 63);
+	}
+
+	//Chunks with marks set before generating have no mines
+	countMines(0, height);
+
+	revision++;
+}
+
+float Minefield::getGenerateProgress() const
+{
+	int bandCount = (height + GENERATE_BAND_ROWS - 1) / GENERATE_BAND_ROWS;
+
+	return (bandCount > 0) ? std::min(1.0f, generatedBands / (2.0f * bandCount)) : 0.0f;
+}
+
+//Mines are placed on tiles with the smallest keys, that's uniformly random choice of exactly mines tiles
+//Keys are first counted in buckets by their top bits to find bucket of the last mine, only keys in that bucket are sorted
+//Bands are independent, so the result is the same with any number of threads
+void Minefield::generateInBands(uint64_t seed, int selectedRow, int selectedColumn, ThreadPool* threadPool)
+{
+	const int bucketCount = 1 << GENERATE_BUCKET_BITS;
+	const int bucketShift = 64 - GENERATE_BUCKET_BITS;
+
+	int bandCount = (height + GENERATE_BAND_ROWS - 1) / GENERATE_BAND_ROWS;
+	std::vector<uint32_t> bandBuckets((size_t)bandCount * bucketCount, 0);
+
+	//Selected tile never gets mine
+	auto isSelected = [selectedRow, selectedColumn](int row, int column) { return row == selectedRow && column == selectedColumn; };
+
+	ThreadPool::forEachBand(threadPool, height, GENERATE_BAND_ROWS, [&](int band, int firstRow, int lastRow)
+	{
+		uint32_t* buckets = bandBuckets.data() + (size_t)band * bucketCount;
+
+		for (int row = firstRow; row < lastRow; row++)
+		{
+			for (int col = 0; col < width; col++)
+			{
+				if (!isSelected(row, col))
+				{
+					buckets[getTileKey(seed, (uint64_t)row * width + col) >> bucketShift]++;
+				}
+			}
+		}
+
+		generatedBands++;
+	});
+
+	//Find bucket where mines end
+	int lastBucket = 0;
+	int64_t minesBefore = 0;
+
+	for (; lastBucket < bucketCount; lastBucket++)
+	{
+		int64_t bucketTiles = 0;
+
+		for (int band = 0; band < bandCount; band++)
+		{
+			bucketTiles += bandBuckets[(size_t)band * bucketCount + lastBucket];
+		}
+
+		if (minesBefore + bucketTiles >= mines)
+		{
+			break;
+		}
+
+		minesBefore += bucketTiles;
+	}
+
+	//Tiles with keys in lower buckets are mines, tiles from last bucket are only collected
+	std::vector<std::vector<std::pair<uint64_t, uint64_t>>> bandCandidates(bandCount);
+
+	ThreadPool::forEachBand(threadPool, height, GENERATE_BAND_ROWS, [&](int band, int firstRow, int lastRow)
+	{
+		for (int row = firstRow; row < lastRow; row++)
+		{
+			uint64_t* rowBits = mineBits.data() + (size_t)row * rowWords;
+
+			for (int word = 0; word < rowWords; word++)
+			{
+				uint64_t bits = 0;
+
+				for (int col = word * 64; col < std::min(width, (word + 1) * 64); col++)
+				{
+					if (isSelected(row, col))
+					{
+						continue;
+					}
+
+					uint64_t tileIndex = (uint64_t)row * width + col;
+					uint64_t key = getTileKey(seed, tileIndex);
+					int bucket = (int)(key >> bucketShift);
+
+					//Mines are placed without branching, most tiles are decided by bucket alone
+					bits |= (uint64_t)(bucket < lastBucket) << (col & 63);
+
+					if (bucket == lastBucket)
+					{
+						bandCandidates[band].emplace_back(key, tileIndex);
+					}
+				}
+
+				rowBits[word] = bits;
+			}
+		}
+
+		generatedBands++;
+	});
+
+	std::vector<std::pair<uint64_t, uint64_t>> candidates;
+
+	for (const auto& band : bandCandidates)
+	{
+		candidates.insert(candidates.end(), band.begin(), band.end());
+	}
+
+	size_t remaining = (size_t)(mines - minesBefore);
+
+	if (remaining < candidates.size())
+	{
+		std::nth_element(candidates.begin(), candidates.begin() + remaining, candidates.end());
+	}
+
+	for (size_t i = 0; i < std::min(remaining, candidates.size()); i++)
+	{
+		uint64_t tileIndex = candidates[i].second;
+		mineBits[(tileIndex / width) * rowWords + (tileIndex % width) / 64] |= (uint64_t)1 << (tileIndex % width % 64);
+	}
+}
+
+void Minefield::countMines(int firstRow, int lastRow)
+{
+	for (int chunkRow = firstRow >> CHUNK_SHIFT; chunkRow <= (lastRow - 1) >> CHUNK_SHIFT; chunkRow++)
+	{
+		int rowStart = std::max(firstRow, chunkRow * CHUNK_SIZE);
+		int rowEnd = std::min(lastRow, (chunkRow + 1) * CHUNK_SIZE);
+
+		for (int chunkColumn = 0; chunkColumn < chunkColumns; chunkColumn++)
+		{
+			FieldType* chunk = stateChunks[(size_t)chunkRow * chunkColumns + chunkColumn].get();
+
+			if (chunk == NULL)
+			{
+				continue;
+			}
+
+			int columnEnd = std::min(width, (chunkColumn + 1) * CHUNK_SIZE);
+
+			for (int row = rowStart; row < rowEnd; row++)
+			{
+				for (int col = chunkColumn * CHUNK_SIZE; col < columnEnd; col++)
+				{
+					FieldType& state = chunk[getChunkTileIndex(row, col)];
+					state = (state & ~FIELD_COUNT_MASK) | (isMine(row, col) ? FIELD_MINE : countMinesAround(row, col));
+				}
+			}
+		}
+	}
+}
+
+//Mines of tiles column - 1 to column + 1 are read from row bitsets as three bit number
+static int countMinesAround(const uint64_t* mineBits, int rowWords, int height, int row, int column)
+{
+	static const uint8_t bitCounts[8] = { 0, 1, 1, 2, 1, 2, 2, 3 };
+
+	int firstColumn = column - 1;
+	int word = firstColumn >> 6;
+	int bit = firstColumn & 63;
+	int count = 0;
+
+	for (int r = std::max(row - 1, 0); r <= std::min(row + 1, height - 1); r++)
+	{
+		const uint64_t* rowBits = mineBits + (size_t)r * rowWords;
+		uint64_t bits;
+
+		if (firstColumn < 0)
+		{
+			bits = rowBits[0] << 1;
+		}
+		else
+		{
+			bits = rowBits[word] >> bit;
+
+			if (bit > 61 && word + 1 < rowWords)
+			{
+				bits |= rowBits[word + 1] << (64 - bit);
+			}
+		}
+
+		count += bitCounts[bits & 7];
+	}
+
+	return count;
+}
+
+int Minefield::countMinesAround(int row, int column) const
+{
+	return ::countMinesAround(mineBits.data(), rowWords, height, row, column);
+}
+
+Minefield::StateChunk Minefield::createEmptyChunk(size_t chunk) const
+{
+	StateChunk tiles = pagedStorage.isOpen() ? StateChunk(pagedStorage.getData() + chunk * CHUNK_TILES, ChunkDeleter()) : allocateChunk();
+	memset(tiles.get(), 0, CHUNK_TILES);
+
+	return tiles;
+}
+
+//Tiles outside of the field stay empty
+Minefield::StateChunk Minefield::createChunk(size_t chunk) const
+{
+	StateChunk tiles = createEmptyChunk(chunk);
+
+	int firstRow = (int)(chunk / chunkColumns) * CHUNK_SIZE;
+	int firstColumn = (int)(chunk % chunkColumns) * CHUNK_SIZE;
+	int rowEnd = std::min(height, firstRow + CHUNK_SIZE);
+	int columnEnd = std::min(width, firstColumn + CHUNK_SIZE);
+
+	for (int row = firstRow; row < rowEnd; row++)
+	{
+		for (int col = firstColumn; col < columnEnd; col++)
+		{
+			tiles[getChunkTileIndex(row, col)] = isMine(row, col) ? FIELD_MINE : countMinesAround(row, col);
+		}
+	}
+
+	return tiles;
+}
+
+void Minefield::prefetchArea(int firstRow, int lastRow, int firstColumn, int lastColumn) const
+{
+	adviseArea(firstRow, lastRow, firstColumn, lastColumn, true);
+}
+
+void Minefield::releaseArea(int firstRow, int lastRow, int firstColumn, int lastColumn) const
+{
+	adviseArea(firstRow, lastRow, firstColumn, lastColumn, false);
+}
+
+//Chunks of one row are next to each other in the file, so every row of chunks is one range
+void Minefield::adviseArea(int firstRow, int lastRow, int firstColumn, int lastColumn, bool prefetch) const
+{
+	firstRow = std::max(firstRow, 0);
+	lastRow = std::min(lastRow, height);
+	firstColumn = std::max(firstColumn, 0);
+	lastColumn = std::min(lastColumn, width);
+
+	if (!pagedStorage.isOpen() || firstRow >= lastRow || firstColumn >= lastColumn)
+	{
+		return;
+	}
+
+	for (int chunkRow = firstRow >> CHUNK_SHIFT; chunkRow <= (lastRow - 1) >> CHUNK_SHIFT; chunkRow++)
+	{
+		size_t firstChunk = (size_t)chunkRow * chunkColumns + (firstColumn >> CHUNK_SHIFT);
+		size_t lastChunk = (size_t)chunkRow * chunkColumns + ((lastColumn - 1) >> CHUNK_SHIFT);
+
+		if (prefetch)
+		{
+			pagedStorage.prefetch(firstChunk * CHUNK_TILES, (lastChunk - firstChunk + 1) * CHUNK_TILES);
+		}
+		else
+		{
+			pagedStorage.release(firstChunk * CHUNK_TILES, (lastChunk - firstChunk + 1) * CHUNK_TILES);
+		}
+	}
+}
+
+size_t Minefield::getChunkCount() const
+{
+	return std::count_if(stateChunks.begin(), stateChunks.end(), [](const StateChunk& chunk) { return chunk != NULL; });
+}
+
+//Tiles waiting for uncovering are kept on own stack instead of recursion so big fields can't overflow call stack
+bool Minefield::uncover(int row, int column)
+{
+	beginStep();
+
+	if (isMine(row, column))
+	{
+		exploded = true;
+		return false;
+	}
+
+	tileStack.clear();
+	tileStack.push_back(row * width + column);
+
+	while (!tileStack.empty())
+	{
+		int index = tileStack.back();
+		tileStack.pop_back();
+
+		int r = index / width;
+		int c = index % width;
+
+		//Skip tiles that are not hidden, with mine or with flag
+		if ((getState(r, c) & (FIELD_VISIBLE | FIELD_FLAG)) || isMine(r, c))
+		{
+			continue;
+		}
+
+		FieldType& state = changeTile(r, c);
+		state |= FIELD_VISIBLE;
+		visibleCount++;
+
+		//If field is count then continue after making it visible
+		if ((state & FIELD_COUNT_MASK) > 0)
+		{
+			continue;
+		}
+
+		//Push all neighbours that are inside the field
+		for (int nr = std::max(r - 1, 0); nr <= std::min(r + 1, height - 1); nr++)
+		{
+			for (int nc = std::max(c - 1, 0); nc <= std::min(c + 1, width - 1); nc++)
+			{
+				if (!(getState(nr, nc) & FIELD_VISIBLE))
+				{
+					tileStack.push_back(nr * width + nc);
+				}
+			}
+		}
+	}
+
+	revision++;
+
+	return true;
+}
+
+void Minefield::mark(int row, int column, bool marksEnabled)
+{
+	//Can't mark visible fields
+	if (getState(row, column) & FIELD_VISIBLE)
+	{
+		return;
+	}
+
+	beginStep();
+
+	FieldType& state = changeTile(row, column);
+	revision++;
+
+	if (state & FIELD_UNKNOWN)
+	{
+		state &= ~FIELD_UNKNOWN;
+		return;
+	}
+
+	if (!(state & FIELD_FLAG))
+	{
+		state |= FIELD_FLAG;
+		flagCount--;
+		return;
+	}
+
+	state &= ~FIELD_FLAG;
+	flagCount++;
+
+	if (marksEnabled)
+	{
+		state |= FIELD_UNKNOWN;
+	}
+}
+
+//Mines are shown as visible by getTile(), so chunks don't have to be allocated for every mine
+void Minefield::expose()
+{
+	exposed = true;
+	revision++;
+}
+
+void Minefield::setUndoLimit(int undoLimit)
+{
+	this->undoLimit = undoLimit;
+
+	while ((int)undoSteps.size() > undoLimit)
+	{
+		undoSteps.pop_front();
+	}
+
+	if (undoLimit == 0)
+	{
+		redoSteps.clear();
+		stepNumber = 0;
+		std::fill(chunkSteps.begin(), chunkSteps.end(), 0);
+	}
+}
+
+bool Minefield::undo()
+{
+	if (undoSteps.empty())
+	{
+		return false;
+	}
+
+	swapStep(undoSteps.back());
+	redoSteps.push_back(std::move(undoSteps.back()));
+	undoSteps.pop_back();
+
+	return true;
+}
+
+bool Minefield::redo()
+{
+	if (redoSteps.empty())
+	{
+		return false;
+	}
+
+	swapStep(redoSteps.back());
+	undoSteps.push_back(std::move(redoSteps.back()));
+	redoSteps.pop_back();
+
+	return true;
+}
+
+void Minefield::clearSteps()
+{
+	undoSteps.clear();
+	redoSteps.clear();
+	std::fill(chunkSteps.begin(), chunkSteps.end(), 0);
+	stepNumber = 0;
+}
+
+//New move makes reverted moves invalid
+void Minefield::beginStep()
+{
+	if (undoLimit == 0)
+	{
+		return;
+	}
+
+	redoSteps.clear();
+
+	if ((int)undoSteps.size() >= undoLimit)
+	{
+		undoSteps.pop_front();
+	}
+
+	undoSteps.push_back({ {}, flagCount, visibleCount, exploded, exposed });
+	stepNumber++;
+}
+
+void Minefield::saveChunk(size_t chunk)
+{
+	chunkSteps[chunk] = stepNumber;
+
+	ChunkCopy copy;
+	copy.chunk = chunk;
+
+	//Clicked state belongs to mouse button that is currently pressed, not to the move
+	if (stateChunks[chunk])
+	{
+		copy.tiles = allocateChunk();
+
+		for (int i = 0; i < CHUNK_TILES; i++)
+		{
+			copy.tiles[i] = stateChunks[chunk][i] & ~FIELD_CLICKED;
+		}
+	}
+
+	undoSteps.back().chunks.push_back(std::move(copy));
+}
+
+void Minefield::swapStep(UndoStep& step)
+{
+	for (ChunkCopy& copy : step.chunks)
+	{
+		StateChunk& tiles = stateChunks[copy.chunk];
+
+		//Paged chunk keeps its place in the file, so tiles are exchanged instead of pointers
+		if (isPagedChunk(tiles))
+		{
+			if (!copy.tiles)
+			{
+				copy.tiles = allocateChunk();
+				memcpy(copy.tiles.get(), tiles.get(), CHUNK_TILES);
+				tiles.reset();
+			}
+			else
+			{
+				std::swap_ranges(tiles.get(), tiles.get() + CHUNK_TILES, copy.tiles.get());
+			}
+		}
+		else if (!tiles && copy.tiles && pagedStorage.isOpen())
+		{
+			tiles = StateChunk(pagedStorage.getData() + copy.chunk * CHUNK_TILES, ChunkDeleter());
+			memcpy(tiles.get(), copy.tiles.get(), CHUNK_TILES);
+			copy.tiles.reset();
+		}
+		else
+		{
+			std::swap(tiles, copy.tiles);
+		}
+
+		chunkRevisions[copy.chunk] = revision;
+
+		if (copy.tiles)
+		{
+			for (int i = 0; i < CHUNK_TILES; i++)
+			{
+				copy.tiles[i] &= ~FIELD_CLICKED;
+			}
+		}
+	}
+
+	std::swap(flagCount, step.flagCount);
+	std::swap(visibleCount, step.visibleCount);
+	std::swap(exploded, step.exploded);
+	std::swap(exposed, step.exposed);
+
+	revision++;
+}
+
+void Minefield::setClicked(int row, int column, bool clicked)
+{
+	if (clicked)
+	{
+		tile(row, column) |= FIELD_CLICKED;
+	}
+	else
+	{
+		tile(row, column) &= ~FIELD_CLICKED;
+	}
+
+	revision++;
+}
+
+bool Minefield::isSelectable(int row, int column) const
+{
+	return !(getState(row, column) & (FIELD_VISIBLE | FIELD_FLAG));
+}
+
+//Every opening (connected area of empty tiles with counts around it) needs one click and every count outside openings needs own click
+int Minefield::calculate3BV(const std::vector<uint64_t>& mineBits, int width, int height)
+{
+	int rowWords = (width + 63) / 64;
+
+	auto isMine = [&mineBits, rowWords](int row, int column)
+	{
+		return ((mineBits[(size_t)row * rowWords + (column >> 6)] >> (column & 63)) & 1) != 0;
+	};
+
+	//Tile without mine and without mines around it
+	auto isEmpty = [&](int row, int column)
+	{
+		return !isMine(row, column) && ::countMinesAround(mineBits.data(), rowWords, height, row, column) == 0;
+	};
+
+	std::vector<bool> covered((size_t)width * height, false);
+	std::vector<int64_t> openingStack;
+	int bv = 0;
+
+	for (int row = 0; row < height; row++)
+	{
+		for (int col = 0; col < width; col++)
+		{
+			if (covered[(size_t)row * width + col] || !isEmpty(row, col))
+			{
+				continue;
+			}
+
+			//New opening - mark all tiles uncovered by clicking it
+			bv++;
+			covered[(size_t)row * width + col] = true;
+			openingStack.push_back((int64_t)row * width + col);
+
+			while (!openingStack.empty())
+			{
+				int64_t index = openingStack.back();
+				openingStack.pop_back();
+
+				int r = (int)(index / width);
+				int c = (int)(index % width);
+
+				for (int nr = std::max(r - 1, 0); nr <= std::min(r + 1, height - 1); nr++)
+				{
+					for (int nc = std::max(c - 1, 0); nc <= std::min(c + 1, width - 1); nc++)
+					{
+						if (covered[(size_t)nr * width + nc])
+						{
+							continue;
+						}
+
+						covered[(size_t)nr * width + nc] = true;
+
+						if (isEmpty(nr, nc))
+						{
+							openingStack.push_back((int64_t)nr * width + nc);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	for (int row = 0; row < height; row++)
+	{
+		for (int col = 0; col < width; col++)
+		{
+			if (!covered[(size_t)row * width + col] && !isMine(row, col))
+			{
+				bv++;
+			}
+		}
+	}
+
+	return bv;
+}
+
+//Word of bitplane is one row of chunk
+void Minefield::packRow(int row, uint64_t* minePlane, uint64_t* visiblePlane, uint64_t* flagPlane, uint64_t* unknownPlane) const
+{
+	static_assert(CHUNK_SIZE == 64, "Bitplane word has to cover one row of chunk");
+
+	memcpy(minePlane, mineBits.data() + (size_t)row * rowWords, rowWords * sizeof(uint64_t));
+
+	for (int word = 0; word < rowWords; word++)
+	{
+		uint64_t visibleBits = 0, flagBits = 0, unknownBits = 0;
+		const FieldType* chunk = stateChunks[(size_t)(row >> CHUNK_SHIFT) * chunkColumns + word].get();
+
+		if (chunk != NULL)
+		{
+			const FieldType* tiles = chunk + ((row & (CHUNK_SIZE - 1)) << CHUNK_SHIFT);
+
+			for (int i = 0; i < CHUNK_SIZE; i++)
+			{
+				uint64_t bit = (uint64_t)1 << i;
+
+				visibleBits |= (tiles[i] & FIELD_VISIBLE) ? bit : 0;
+				flagBits |= (tiles[i] & FIELD_FLAG) ? bit : 0;
+				unknownBits |= (tiles[i] & FIELD_UNKNOWN) ? bit : 0;
+			}
+		}
+
+		visiblePlane[word] = visibleBits;
+		flagPlane[word] = flagBits;
+		unknownPlane[word] = unknownBits;
+	}
+}
+
+//Chunks are allocated only for words with some state bit set, their mine counts are left empty
+//because mine bits of neighbour rows may not be unpacked yet
+void Minefield::unpackRow(int row, const uint64_t* minePlane, const uint64_t* visiblePlane, const uint64_t* flagPlane, const uint64_t* unknownPlane)
+{
+	uint64_t* rowBits = mineBits.data() + (size_t)row * rowWords;
+	uint64_t lastWordMask = (width % 64 == 0) ? ~(uint64_t)0 : ((uint64_t)1 << (width % 64)) - 1;
+
+	//Bits past the last column would break mine counts on right edge
+	memcpy(rowBits, minePlane, rowWords * sizeof(uint64_t));
+	rowBits[rowWords - 1] &= lastWordMask;
+
+	for (int word = 0; word < rowWords; word++)
+	{
+		uint64_t stateBits = visiblePlane[word] | flagPlane[word] | unknownPlane[word];
+
+		if ((word == rowWords - 1 ? stateBits & lastWordMask : stateBits) == 0)
+		{
+			continue;
+		}
+
+		size_t chunkIndex = getChunkIndex(row, word * 64);
+		StateChunk& chunk = stateChunks[chunkIndex];
+
+		if (!chunk)
+		{
+			chunk = createEmptyChunk(chunkIndex);
+		}
+
+		chunkRevisions[chunkIndex] = revision;
+
+		int columnEnd = std::min(width, (word + 1) * 64);
+
+		for (int col = word * 64; col < columnEnd; col++)
+		{
+			int bit = col & 63;
+
+			FieldType state = ((visiblePlane[word] >> bit) & 1) ? FIELD_VISIBLE : 0;
+			state |= ((flagPlane[word] >> bit) & 1) ? FIELD_FLAG : 0;
+			state |= ((unknownPlane[word] >> bit) & 1) ? FIELD_UNKNOWN : 0;
+
+			FieldType& tileState = chunk[getChunkTileIndex(row, col)];
+			tileState = (tileState & FIELD_COUNT_MASK) | state;
+		}
+	}
+}
+
+void Minefield::restoreCounters(int64_t visibleCount, int flagCount)
+{
+	this->visibleCount = visibleCount;
+	this->flagCount = flagCount;
+
+	revision++;
+}
@@ -0,0 +1,306 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "threadpool.h"
+#include "pagedstorage.h"
+#include "blockarena.h"
+
+//Maximal width and height of custom field, also with paged storage (tile indexes are 32 bit in many places)
+//so paged field is at most 100 MB of tile state and doesn't exceed memory, it only lets system drop unused parts
+#define MAX_FIELD_SIZE 10000
+
+//Field state packed in one byte
+//Low four bits hold mine count around field (0-8) or FIELD_MINE if field is mine
+#define FIELD_COUNT_MASK 0x0F
+#define FIELD_MINE 0x0F
+#define FIELD_VISIBLE 0x10 //Field visible
+#define FIELD_FLAG 0x20 //Field with flag
+#define FIELD_UNKNOWN 0x40 //Unknown field
+#define FIELD_CLICKED 0x80 //Field that user clicks (draw pushed button instead of normal)
+
+//Tile state is stored in square chunks, so move changes only few of them and they can be copied for undo
+//Chunk is allocated when some its tile changes for the first time
+#define CHUNK_SHIFT 6
+#define CHUNK_SIZE (1 << CHUNK_SHIFT) //Width and height of chunk in tiles
+#define CHUNK_TILES (CHUNK_SIZE * CHUNK_SIZE)
+
+typedef uint8_t FieldType;
+
+//Mine field with game rules
+//Doesn't depend on SDL, so the same rules are used by the game and by tools (replay verifier)
+//Mines are kept in bitset (one bit per tile), states of tiles only in chunks that player changed
+//so memory of big field depends mostly on revealed area and not on field size
+class Minefield
+{
+public:
+	Minefield();
+
+	//Create field with all tiles hidden and empty, mines are placed by generate()
+	void reset(int width, int height, int mines);
+
+	//Keep tile state chunks in memory mapped file instead of heap, so field doesn't need to fit in memory
+	//Every chunk has fixed place in the file (one page for every chunk, row after row of chunks)
+	//Used from next reset(), empty path goes back to heap, if file can't be created tiles are kept on heap
+	void setPagedStorage(const std::string& path) { pagedStoragePath = path; }
+	bool isPaged() const { return pagedStorage.isOpen(); }
+
+	//Hints for paged storage, area that will be needed soon is read ahead and area that was left
+	//can leave memory (it does nothing for tiles on heap)
+	void prefetchArea(int firstRow, int lastRow, int firstColumn, int lastColumn) const;
+	void releaseArea(int firstRow, int lastRow, int firstColumn, int lastColumn) const;
+
+	//Place mines (never on selected tile) and count mines around tiles
+	//Mine positions depend only on seed and selected tile (not on thread pool or its thread count)
+	void generate(uint64_t seed, int selectedRow, int selectedColumn, ThreadPool* threadPool = NULL);
+
+	//Part of generate() that is done (0 to 1), can be called from other thread while field is generated
+	//Only fields generated in bands report progress
+	float getGenerateProgress() const;
+
+	//Uncover tile and all neighbour empty tiles, returns false if tile is mine
+	bool uncover(int row, int column);
+
+	//Set flag or question mark (if enabled and already flag) on the tile
+	void mark(int row, int column, bool marksEnabled);
+
+	//Make all mines visible after game over (it's part of the losing move)
+	void expose();
+
+	//Keep last undoLimit moves (uncovers and marks) for undo, 0 disables undo history
+	//Move stores copies of chunks it changed, so memory depends on changed area and not on field size
+	void setUndoLimit(int undoLimit);
+
+	//Revert last move or redo reverted one, return false if there is none
+	bool undo();
+	bool redo();
+
+	bool canUndo() const { return !undoSteps.empty(); }
+	bool canRedo() const { return !redoSteps.empty(); }
+
+	//Set or clear clicked state of the tile
+	void setClicked(int row, int column, bool clicked);
+
+	//Check if tile can be uncovered (it's not visible and without flag)
+	bool isSelectable(int row, int column) const;
+
+	//Check if tile is mine, tiles outside the field are not
+	bool isMine(int row, int column) const
+	{
+		if (row < 0 || row > height - 1 || column < 0 || column > width - 1)
+		{
+			return false;
+		}
+
+		return (mineBits[(size_t)row * rowWords + (column >> 6)] >> (column & 63)) & 1;
+	}
+
+	//All safe tiles are visible
+	bool isCleared() const { return visibleCount == (int64_t)width * height - mines; }
+
+	//Mine was uncovered
+	bool isExploded() const { return exploded; }
+
+	//Calculate 3BV of the field - minimal number of left clicks needed to uncover all safe tiles
+	int calculate3BV() const { return calculate3BV(mineBits, width, height); }
+
+	//3BV of field with given mine bits, it doesn't touch the field so it can run on copy of bits while field changes
+	static int calculate3BV(const std::vector<uint64_t>& mineBits, int width, int height);
+
+	//Mine bits of the field, every row starts at new 64 bit word
+	const std::vector<uint64_t>& getMineBits() const { return mineBits; }
+
+	//Tiles of chunks that aren't allocated are hidden, their mine count is computed from mine bitset
+	FieldType getTile(int row, int column) const
+	{
+		const FieldType* chunk = stateChunks[getChunkIndex(row, column)].get();
+
+		if (chunk == NULL)
+		{
+			return isMine(row, column) ? (exposed ? FIELD_MINE | FIELD_VISIBLE : FIELD_MINE) : countMinesAround(row, column);
+		}
+
+		FieldType state = chunk[getChunkTileIndex(row, column)];
+
+		return (exposed && (state & FIELD_COUNT_MASK) == FIELD_MINE) ? state | FIELD_VISIBLE : state;
+	}
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	int getMines() const { return mines; }
+	int getFlagCount() const { return flagCount; }
+	int64_t getVisibleCount() const { return visibleCount; }
+
+	//Increased on every change of the field
+	unsigned getRevision() const { return revision; }
+
+	//Direct access to chunks for drawing overview of the field
+	int getChunkColumns() const { return chunkColumns; }
+	int getChunkRows() const { return (height + CHUNK_SIZE - 1) >> CHUNK_SHIFT; }
+
+	//Tiles of the chunk (row after row), NULL if no tile of the chunk was changed yet
+	const FieldType* getChunkTiles(size_t chunk) const { return stateChunks[chunk].get(); }
+
+	//Revision in which chunk was changed last time
+	//Chunk changed since getRevision() returned some revision has the same or higher revision
+	unsigned getChunkRevision(size_t chunk) const { return chunkRevisions[chunk]; }
+
+	//Bitplane access used by saved games - one bit per tile (bit i of word w is column w * 64 + i)
+	//Row of every plane takes getRowWords() words
+	int getRowWords() const { return rowWords; }
+
+	void packRow(int row, uint64_t* minePlane, uint64_t* visiblePlane, uint64_t* flagPlane, uint64_t* unknownPlane) const;
+
+	//Restore tiles of the row from bitplanes, field has to be reset to the right size first
+	//Rows of one chunk (CHUNK_SIZE rows starting at multiple of CHUNK_SIZE) can't be unpacked in parallel
+	//After all rows are unpacked mine counts have to be restored with countMines() and counters with restoreCounters()
+	void unpackRow(int row, const uint64_t* minePlane, const uint64_t* visiblePlane, const uint64_t* flagPlane, const uint64_t* unknownPlane);
+
+	//Update mine counts in allocated chunks of rows [firstRow, lastRow), chunk rows can be processed in parallel
+	void countMines(int firstRow, int lastRow);
+
+	//Number of allocated state chunks
+	size_t getChunkCount() const;
+
+	void restoreCounters(int64_t visibleCount, int flagCount);
+
+private:
+	//Chunk tiles go back to the arena they came from
+	//Chunk in paged storage has no arena and isn't freed, its place in the file is reused when chunk is created again
+	struct ChunkDeleter
+	{
+		ChunkDeleter() : arena(NULL) {}
+		explicit ChunkDeleter(BlockArena* arena) : arena(arena) {}
+
+		void operator()(FieldType* tiles) const
+		{
+			if (arena != NULL)
+			{
+				arena->release(tiles);
+			}
+		}
+
+		BlockArena* arena;
+	};
+
+	typedef std::unique_ptr<FieldType[], ChunkDeleter> StateChunk;
+
+	//Tiles of the move before it changed them, empty chunk wasn't allocated
+	struct ChunkCopy
+	{
+		size_t chunk;
+		StateChunk tiles;
+	};
+
+	struct UndoStep
+	{
+		std::vector<ChunkCopy> chunks;
+		int flagCount;
+		int64_t visibleCount;
+		bool exploded, exposed;
+	};
+
+	size_t getChunkIndex(int row, int column) const { return (size_t)(row >> CHUNK_SHIFT) * chunkColumns + (column >> CHUNK_SHIFT); }
+	static int getChunkTileIndex(int row, int column) { return ((row & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) | (column & (CHUNK_SIZE - 1)); }
+
+	int countMinesAround(int row, int column) const;
+
+	void adviseArea(int firstRow, int lastRow, int firstColumn, int lastColumn, bool prefetch) const;
+
+	//Place mines of big field in bands of rows, see generate()
+	void generateInBands(uint64_t seed, int selectedRow, int selectedColumn, ThreadPool* threadPool);
+
+	//State bits of the tile without computing mine count for tiles that aren't allocated
+	FieldType getState(int row, int column) const
+	{
+		const FieldType* chunk = stateChunks[getChunkIndex(row, column)].get();
+
+		return (chunk != NULL) ? chunk[getChunkTileIndex(row, column)] : 0;
+	}
+
+	//Tiles from the arena, they aren't initialized
+	StateChunk allocateChunk() const { return StateChunk((FieldType*)chunkArena.allocate(), ChunkDeleter(&chunkArena)); }
+
+	static bool isPagedChunk(const StateChunk& tiles) { return tiles && tiles.get_deleter().arena == NULL; }
+
+	//Create chunk with all tiles cleared
+	StateChunk createEmptyChunk(size_t chunk) const;
+
+	//Create chunk with mine counts of its tiles
+	StateChunk createChunk(size_t chunk) const;
+
+	//Tile access that isn't part of any move
+	FieldType& tile(int row, int column)
+	{
+		size_t chunkIndex = getChunkIndex(row, column);
+		StateChunk& chunk = stateChunks[chunkIndex];
+
+		if (!chunk)
+		{
+			chunk = createChunk(chunkIndex);
+		}
+
+		chunkRevisions[chunkIndex] = revision;
+
+		return chunk[getChunkTileIndex(row, column)];
+	}
+
+	//Tile access for changes made by move, chunk is copied to undo history before its first change
+	FieldType& changeTile(int row, int column)
+	{
+		size_t chunk = getChunkIndex(row, column);
+
+		if (chunkSteps[chunk] != stepNumber)
+		{
+			saveChunk(chunk);
+		}
+
+		return tile(row, column);
+	}
+
+	void beginStep();
+	void saveChunk(size_t chunk);
+
+	//Remove all undo and redo steps
+	void clearSteps();
+
+	//Exchange tiles and counters of the field with the step
+	void swapStep(UndoStep& step);
+
+	int width, height, mines, flagCount, rowWords, chunkColumns, undoLimit;
+	int64_t visibleCount;
+	bool exploded, exposed;
+	unsigned revision;
+	std::vector<uint64_t> mineBits; //Row after row, getRowWords() words per row
+	mutable BlockArena chunkArena; //Memory of chunks and their undo copies, declared before them so it outlives them
+	std::vector<StateChunk> stateChunks; //Tiles of chunk row after row
+	std::atomic<int> generatedBands; //Bands finished by both passes of generateInBands()
+	std::string pagedStoragePath;
+	PagedStorage pagedStorage;
+	std::vector<unsigned> chunkRevisions;
+	std::deque<UndoStep> undoSteps;
+	std::vector<UndoStep> redoSteps;
+	std::vector<unsigned> chunkSteps; //Step that already has copy of the chunk
+	unsigned stepNumber; //Current step, 0 when there is no step
+	std::vector<int> tileStack; //Tiles waiting for uncovering, kept between calls to avoid allocations
+};
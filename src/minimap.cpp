@@ -0,0 +1,220 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "minimap.h"
+
+#include <algorithm>
+#include <cstring>
+
+//Colours in ARGB8888
+#define MINIMAP_HIDDEN 0xFF7B7B7Bu
+#define MINIMAP_REVEALED 0xFFD6D6D6u
+#define MINIMAP_FLAGGED 0xFFE02020u
+#define MINIMAP_EXPLODED 0xFF000000u
+
+Minimap::Minimap() : texture(NULL), width(0), height(0), blockSize(1), fieldWidth(0), fieldHeight(0), seenRevision(0), seenGameLost(false)
+{
+}
+
+Minimap::~Minimap()
+{
+	destroy();
+}
+
+void Minimap::destroy()
+{
+	if (texture != NULL)
+	{
+		SDL_DestroyTexture(texture);
+		texture = NULL;
+	}
+}
+
+bool Minimap::update(SDL_Renderer* renderer, const Minefield& minefield, bool gameLost)
+{
+	bool rebuild = (texture == NULL || gameLost != seenGameLost);
+
+	if (texture == NULL || fieldWidth != minefield.getWidth() || fieldHeight != minefield.getHeight())
+	{
+		destroy();
+
+		fieldWidth = minefield.getWidth();
+		fieldHeight = minefield.getHeight();
+
+		//Smallest block that keeps texture under size limit, blocks never cross chunk border
+		for (blockSize = 1; blockSize < CHUNK_SIZE && (std::max(fieldWidth, fieldHeight) + blockSize - 1) / blockSize > MINIMAP_MAX_PIXELS; blockSize *= 2);
+
+		width = (fieldWidth + blockSize - 1) / blockSize;
+		height = (fieldHeight + blockSize - 1) / blockSize;
+		pixels.assign((size_t)width * height, MINIMAP_HIDDEN);
+
+		texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+
+		if (texture == NULL)
+		{
+			return false;
+		}
+
+		rebuild = true;
+	}
+
+	//Find chunks changed since last update, only area covering them is uploaded
+	int chunkPixels = CHUNK_SIZE / blockSize;
+	int firstX = width, firstY = height, lastX = 0, lastY = 0;
+
+	for (int chunkRow = 0; chunkRow < minefield.getChunkRows(); chunkRow++)
+	{
+		for (int chunkColumn = 0; chunkColumn < minefield.getChunkColumns(); chunkColumn++)
+		{
+			size_t chunk = (size_t)chunkRow * minefield.getChunkColumns() + chunkColumn;
+
+			if (!rebuild && minefield.getChunkRevision(chunk) < seenRevision)
+			{
+				continue;
+			}
+
+			updateChunk(minefield, chunkRow, chunkColumn, gameLost);
+
+			firstX = std::min(firstX, chunkColumn * chunkPixels);
+			firstY = std::min(firstY, chunkRow * chunkPixels);
+			lastX = std::max(lastX, std::min(width, (chunkColumn + 1) * chunkPixels));
+			lastY = std::max(lastY, std::min(height, (chunkRow + 1) * chunkPixels));
+		}
+	}
+
+	seenRevision = minefield.getRevision();
+	seenGameLost = gameLost;
+
+	if (firstX >= lastX || firstY >= lastY)
+	{
+		return true;
+	}
+
+	SDL_Rect rect = { firstX, firstY, lastX - firstX, lastY - firstY };
+	void* data;
+	int pitch;
+
+	if (SDL_LockTexture(texture, &rect, &data, &pitch) != 0)
+	{
+		return false;
+	}
+
+	for (int y = 0; y < rect.h; y++)
+	{
+		memcpy((Uint8*)data + (size_t)y * pitch, pixels.data() + (size_t)(rect.y + y) * width + rect.x, rect.w * sizeof(Uint32));
+	}
+
+	SDL_UnlockTexture(texture);
+
+	return true;
+}
+
+void Minimap::updateChunk(const Minefield& minefield, int chunkRow, int chunkColumn, bool gameLost)
+{
+	const FieldType* tiles = minefield.getChunkTiles((size_t)chunkRow * minefield.getChunkColumns() + chunkColumn);
+	int chunkPixels = CHUNK_SIZE / blockSize;
+
+	for (int blockRow = 0; blockRow < chunkPixels; blockRow++)
+	{
+		int firstRow = chunkRow * CHUNK_SIZE + blockRow * blockSize;
+
+		if (firstRow >= fieldHeight)
+		{
+			break;
+		}
+
+		for (int blockColumn = 0; blockColumn < chunkPixels; blockColumn++)
+		{
+			int firstColumn = chunkColumn * CHUNK_SIZE + blockColumn * blockSize;
+
+			if (firstColumn >= fieldWidth)
+			{
+				break;
+			}
+
+			Uint32 colour = MINIMAP_HIDDEN;
+
+			//Chunk that isn't allocated is completely hidden
+			if (tiles != NULL)
+			{
+				const FieldType* blockTiles = tiles + (((blockRow * blockSize) << CHUNK_SHIFT) | (blockColumn * blockSize));
+				colour = getBlockColour(blockTiles, std::min(blockSize, fieldHeight - firstRow), std::min(blockSize, fieldWidth - firstColumn), gameLost);
+			}
+
+			pixels[(size_t)(firstRow / blockSize) * width + firstColumn / blockSize] = colour;
+		}
+	}
+}
+
+//Tile states are summed eight at once - visible and flag bits of every byte are moved to the lowest bit
+//and multiplication adds all bytes of the word together
+Uint32 Minimap::getBlockColour(const FieldType* tiles, int rows, int columns, bool gameLost) const
+{
+	static_assert(FIELD_VISIBLE == 0x10 && FIELD_FLAG == 0x20, "Shifts below depend on state bits");
+
+	const uint64_t lowBits = 0x0101010101010101ull;
+	int visible = 0, flags = 0;
+
+	for (int row = 0; row < rows; row++)
+	{
+		const FieldType* rowTiles = tiles + (row << CHUNK_SHIFT);
+		int col = 0;
+
+		for (; col + 8 <= columns; col += 8)
+		{
+			uint64_t word;
+			memcpy(&word, rowTiles + col, sizeof(word));
+
+			visible += (int)((((word >> 4) & lowBits) * lowBits) >> 56);
+			flags += (int)((((word >> 5) & lowBits) * lowBits) >> 56);
+		}
+
+		for (; col < columns; col++)
+		{
+			visible += (rowTiles[col] >> 4) & 1;
+			flags += (rowTiles[col] >> 5) & 1;
+		}
+
+		//Mine that was clicked stays clicked after game over
+		if (gameLost)
+		{
+			for (col = 0; col < columns; col++)
+			{
+				if ((rowTiles[col] & (FIELD_COUNT_MASK | FIELD_CLICKED)) == (FIELD_MINE | FIELD_CLICKED))
+				{
+					return MINIMAP_EXPLODED;
+				}
+			}
+		}
+	}
+
+	if (flags > 0)
+	{
+		return MINIMAP_FLAGGED;
+	}
+
+	//Blend hidden and revealed colour by revealed part of the block
+	int tileCount = rows * columns;
+	Uint32 colour = 0xFF000000u;
+
+	for (int shift = 0; shift < 24; shift += 8)
+	{
+		int hidden = (MINIMAP_HIDDEN >> shift) & 0xFF;
+		int revealed = (MINIMAP_REVEALED >> shift) & 0xFF;
+
+		colour |= (Uint32)(hidden + (revealed - hidden) * visible / tileCount) << shift;
+	}
+
+	return colour;
+}
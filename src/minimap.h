@@ -0,0 +1,56 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+
+#include "minefield.h"
+
+#define MINIMAP_MAX_PIXELS 256 //Largest side of minimap texture
+
+//Overview of the field - one pixel of streaming texture per square block of tiles
+//Block is hidden, revealed (colour depends on revealed part), flagged or exploded
+//Only blocks of chunks changed since last update are computed again
+class Minimap
+{
+public:
+	Minimap();
+	~Minimap();
+
+	//Update texture from the field, texture is created again when field size changes
+	bool update(SDL_Renderer* renderer, const Minefield& minefield, bool gameLost);
+
+	void destroy();
+
+	SDL_Texture* getTexture() const { return texture; }
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+
+	//Side of block of tiles shown by one pixel (power of two that divides CHUNK_SIZE)
+	int getBlockSize() const { return blockSize; }
+
+private:
+	void updateChunk(const Minefield& minefield, int chunkRow, int chunkColumn, bool gameLost);
+	Uint32 getBlockColour(const FieldType* tiles, int rows, int columns, bool gameLost) const;
+
+	SDL_Texture* texture;
+	int width, height, blockSize;
+	int fieldWidth, fieldHeight;
+	unsigned seenRevision;
+	bool seenGameLost;
+	std::vector<Uint32> pixels; //Copy of texture
+};
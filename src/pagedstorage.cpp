@@ -0,0 +1,219 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "pagedstorage.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(WIN32) || defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+PagedStorage::PagedStorage() : data(NULL), size(0), pageSize(4096)
+{
+#if defined(WIN32) || defined(_WIN32)
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	pageSize = systemInfo.dwPageSize;
+#else
+	long systemPageSize = sysconf(_SC_PAGESIZE);
+
+	if (systemPageSize > 0)
+	{
+		pageSize = (size_t)systemPageSize;
+	}
+#endif
+}
+
+PagedStorage::~PagedStorage()
+{
+	close();
+}
+
+void PagedStorage::getPageRange(size_t offset, size_t length, size_t& pageOffset, size_t& pageLength) const
+{
+	size_t end = std::min(size, offset + length);
+
+	pageOffset = offset / pageSize * pageSize;
+	pageLength = (end > pageOffset) ? end - pageOffset : 0;
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+bool PagedStorage::create(const std::string& path, size_t size)
+{
+	close();
+
+	if (size == 0)
+	{
+		return false;
+	}
+
+	//Temporary file stays in cache as long as possible and it's deleted with the last handle
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	//Mapping extends file to its size
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+
+	if (mappingHandle == NULL)
+	{
+		close();
+		return false;
+	}
+
+	data = (unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+	if (data == NULL)
+	{
+		close();
+		return false;
+	}
+
+	this->size = size;
+
+	return true;
+}
+
+void PagedStorage::close()
+{
+	if (data != NULL)
+	{
+		UnmapViewOfFile(data);
+	}
+
+	if (mappingHandle != NULL)
+	{
+		CloseHandle(mappingHandle);
+	}
+
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+	}
+
+	data = NULL;
+	size = 0;
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+}
+
+//There is no read ahead hint for mapped files that works on all supported Windows versions
+void PagedStorage::prefetch(size_t offset, size_t length) const
+{
+}
+
+//Unlocking memory that isn't locked removes its pages from working set
+void PagedStorage::release(size_t offset, size_t length) const
+{
+	size_t pageOffset, pageLength;
+	getPageRange(offset, length, pageOffset, pageLength);
+
+	if (pageLength > 0)
+	{
+		VirtualUnlock(data + pageOffset, pageLength);
+	}
+}
+
+#else
+
+bool PagedStorage::create(const std::string& path, size_t size)
+{
+	close();
+
+	if (size == 0)
+	{
+		return false;
+	}
+
+	int fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	//File is sparse, only pages that were written take disk space
+	if (ftruncate(fileDescriptor, (off_t)size) != 0)
+	{
+		::close(fileDescriptor);
+		unlink(path.c_str());
+		return false;
+	}
+
+	void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+
+	//Mapping keeps the file alive after removing its name and closing descriptor
+	::close(fileDescriptor);
+	unlink(path.c_str());
+
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data = (unsigned char*)mapping;
+	this->size = size;
+
+	return true;
+}
+
+void PagedStorage::close()
+{
+	if (data != NULL)
+	{
+		munmap(data, size);
+	}
+
+	data = NULL;
+	size = 0;
+}
+
+void PagedStorage::prefetch(size_t offset, size_t length) const
+{
+	size_t pageOffset, pageLength;
+	getPageRange(offset, length, pageOffset, pageLength);
+
+	if (pageLength > 0)
+	{
+		madvise(data + pageOffset, pageLength, MADV_WILLNEED);
+	}
+}
+
+//Pages of shared mapping are dropped only from the process, changed data is kept in page cache and written to the file
+void PagedStorage::release(size_t offset, size_t length) const
+{
+	size_t pageOffset, pageLength;
+	getPageRange(offset, length, pageOffset, pageLength);
+
+	if (pageLength > 0)
+	{
+		madvise(data + pageOffset, pageLength, MADV_DONTNEED);
+	}
+}
+
+#endif
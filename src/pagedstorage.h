@@ -0,0 +1,57 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+//Read-write memory mapping of file created for data that may not fit in memory
+//Pages are loaded on first access and written back to the file by the system when memory is needed
+//File is removed when storage is closed or when the process ends
+class PagedStorage
+{
+public:
+	PagedStorage();
+	~PagedStorage();
+
+	PagedStorage(const PagedStorage&) = delete;
+	PagedStorage& operator=(const PagedStorage&) = delete;
+
+	//Create file of given size filled with zeros and map it, existing file is replaced
+	bool create(const std::string& path, size_t size);
+	void close();
+
+	bool isOpen() const { return data != NULL; }
+	unsigned char* getData() const { return data; }
+	size_t getSize() const { return size; }
+
+	//Hint that range will be accessed soon, so its pages can be read ahead
+	void prefetch(size_t offset, size_t length) const;
+
+	//Hint that range won't be accessed for some time, its pages can leave memory (data stays in the file)
+	void release(size_t offset, size_t length) const;
+
+private:
+	//Extend range to whole pages
+	void getPageRange(size_t offset, size_t length, size_t& pageOffset, size_t& pageLength) const;
+
+	unsigned char* data;
+	size_t size, pageSize;
+
+#if defined(WIN32) || defined(_WIN32)
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+};
@@ -0,0 +1,78 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+//Pseudo random number generator with fully specified output - xoshiro256** seeded by SplitMix64
+//Unlike standard library engines with distributions it gives the same numbers with every compiler and standard library,
+//so the same seed always generates the same field
+class Random
+{
+public:
+	explicit Random(uint64_t seed = 0);
+
+	uint64_t next()
+	{
+		uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+		uint64_t shifted = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= shifted;
+		state[3] = rotateLeft(state[3], 45);
+
+		return result;
+	}
+
+	//Uniform number in range [0, bound) - multiply and reject method by Daniel Lemire
+	uint32_t nextBounded(uint32_t bound)
+	{
+		uint64_t product = (next() >> 32) * bound;
+		uint32_t low = (uint32_t)product;
+
+		if (low < bound)
+		{
+			uint32_t threshold = (0u - bound) % bound;
+
+			while (low < threshold)
+			{
+				product = (next() >> 32) * bound;
+				low = (uint32_t)product;
+			}
+		}
+
+		return (uint32_t)(product >> 32);
+	}
+
+	//Step of SplitMix64 generator, also usable as good 64 bit mixing function
+	static uint64_t splitMix64(uint64_t& value)
+	{
+		value += 0x9E3779B97F4A7C15ull;
+
+		uint64_t result = value;
+		result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ull;
+		result = (result ^ (result >> 27)) * 0x94D049BB133111EBull;
+
+		return result ^ (result >> 31);
+	}
+
+private:
+	static uint64_t rotateLeft(uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+
+	uint64_t state[4];
+};
@@ -0,0 +1,258 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "replay.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "mappedfile.h"
+
+#define REPLAY_ARCHIVE_MAGIC "DSDR"
+
+ReplayRecorder::ReplayRecorder() : recording(false), mode(0), width(0), height(0), mines(0), seed(0), lastTime(0), actionCount(0)
+{
+	actions.reserve(BUFFER_SIZE);
+	replay.reserve(BUFFER_SIZE);
+}
+
+void ReplayRecorder::start(int mode, int width, int height, int mines, uint64_t seed, uint32_t time)
+{
+	this->mode = mode;
+	this->width = width;
+	this->height = height;
+	this->mines = mines;
+	this->seed = seed;
+
+	lastTime = time;
+	actionCount = 0;
+	actions.clear();
+	recording = true;
+}
+
+bool ReplayRecorder::finish(const std::string& archivePath, ReplayResult result, uint32_t gameTime)
+{
+	if (!recording)
+	{
+		return false;
+	}
+
+	recording = false;
+
+	if (archivePath.empty())
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> header;
+	header.push_back((uint8_t)FORMAT_VERSION);
+	header.push_back((uint8_t)mode);
+	header.push_back((uint8_t)result);
+	writeVarint(header, width);
+	writeVarint(header, height);
+	writeVarint(header, mines);
+
+	for (int i = 0; i < 8; i++)
+	{
+		header.push_back((uint8_t)(seed >> (i * 8)));
+	}
+
+	writeVarint(header, gameTime);
+	writeVarint(header, actionCount);
+
+	//Whole replay goes to file with one write
+	replay.clear();
+	writeVarint(replay, header.size() + actions.size());
+	replay.insert(replay.end(), header.begin(), header.end());
+	replay.insert(replay.end(), actions.begin(), actions.end());
+
+	//Tail of archive is checked before the first replay is appended to it
+	if (archivePath != repairedArchivePath)
+	{
+		if (!repairArchive(archivePath))
+		{
+			return false;
+		}
+
+		repairedArchivePath = archivePath;
+	}
+
+	std::error_code errorCode;
+	bool newArchive = !std::filesystem::exists(archivePath, errorCode) || std::filesystem::file_size(archivePath, errorCode) == 0;
+	FILE* file = fopen(archivePath.c_str(), "ab");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool written = !newArchive || fwrite(REPLAY_ARCHIVE_MAGIC, 4, 1, file) == 1;
+	written = written && fwrite(replay.data(), replay.size(), 1, file) == 1;
+	written = (fclose(file) == 0) && written;
+
+	return written;
+}
+
+//Drop replay cut by interrupted write at the end of archive, otherwise all following replays would be misaligned
+//Archive without complete header is started again, file that isn't archive is left alone
+bool ReplayRecorder::repairArchive(const std::string& archivePath)
+{
+	MappedFile file;
+
+	if (!file.open(archivePath)) //No archive yet
+	{
+		return !std::filesystem::exists(archivePath);
+	}
+
+	size_t fileSize = file.getSize();
+	size_t validSize = 0;
+
+	if (fileSize >= ReplayReader::ARCHIVE_HEADER_SIZE)
+	{
+		if (!ReplayReader::isArchive(file.getData(), fileSize))
+		{
+			return false;
+		}
+
+		validSize = ReplayReader::ARCHIVE_HEADER_SIZE;
+
+		while (validSize < fileSize)
+		{
+			size_t replaySize = ReplayReader::getReplaySize(file.getData() + validSize, fileSize - validSize);
+
+			if (replaySize == 0)
+			{
+				break;
+			}
+
+			validSize += replaySize;
+		}
+	}
+
+	file.close();
+
+	if (validSize == fileSize)
+	{
+		return true;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::resize_file(archivePath, validSize, errorCode);
+
+	return !errorCode;
+}
+
+bool ReplayReader::isArchive(const uint8_t* data, size_t size)
+{
+	return size >= ARCHIVE_HEADER_SIZE && memcmp(data, REPLAY_ARCHIVE_MAGIC, ARCHIVE_HEADER_SIZE) == 0;
+}
+
+size_t ReplayReader::getReplaySize(const uint8_t* data, size_t size)
+{
+	const uint8_t* position = data;
+	uint64_t replaySize;
+
+	if (!readVarint(position, data + size, replaySize) || replaySize > size - (position - data))
+	{
+		return 0;
+	}
+
+	return (position - data) + replaySize;
+}
+
+bool ReplayReader::parseReplay(const uint8_t* data, size_t size, Replay& replay)
+{
+	const uint8_t* end = data + size;
+	uint64_t replaySize, width, height, mines, gameTime, actionCount;
+
+	if (!readVarint(data, end, replaySize) || end - data < 3)
+	{
+		return false;
+	}
+
+	replay.version = data[0];
+	replay.mode = data[1];
+	replay.result = data[2];
+	data += 3;
+
+	if (!readVarint(data, end, width) || !readVarint(data, end, height) || !readVarint(data, end, mines) || end - data < 8)
+	{
+		return false;
+	}
+
+	replay.seed = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		replay.seed |= (uint64_t)data[i] << (i * 8);
+	}
+
+	data += 8;
+
+	if (!readVarint(data, end, gameTime) || !readVarint(data, end, actionCount))
+	{
+		return false;
+	}
+
+	//Values that don't fit in their types can't come from the game
+	if (width > INT32_MAX || height > INT32_MAX || mines > INT32_MAX || gameTime > UINT32_MAX || actionCount > UINT32_MAX)
+	{
+		return false;
+	}
+
+	replay.width = (int)width;
+	replay.height = (int)height;
+	replay.mines = (int)mines;
+	replay.gameTime = (uint32_t)gameTime;
+	replay.actionCount = (uint32_t)actionCount;
+	replay.actions = data;
+	replay.actionsEnd = end;
+
+	return true;
+}
+
+bool ReplayReader::readAction(const uint8_t*& data, const uint8_t* end, ReplayAction& action, uint32_t& tile, uint32_t& timeDelta)
+{
+	uint64_t value, delta;
+
+	if (!readVarint(data, end, value) || !readVarint(data, end, delta) || (value & 7) > ACTION_RESTART || (value >> 3) > UINT32_MAX || delta > UINT32_MAX)
+	{
+		return false;
+	}
+
+	action = (ReplayAction)(value & 7);
+	tile = (uint32_t)(value >> 3);
+	timeDelta = (uint32_t)delta;
+
+	return true;
+}
+
+bool ReplayReader::readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+{
+	value = 0;
+
+	for (int shift = 0; shift < 64 && data < end; shift += 7)
+	{
+		uint8_t byte = *data++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
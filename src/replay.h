@@ -0,0 +1,117 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum ReplayAction { ACTION_REVEAL, ACTION_FLAG, ACTION_UNKNOWN, ACTION_CLEAR, ACTION_RESTART };
+enum ReplayResult { REPLAY_LOST, REPLAY_WON, REPLAY_ABANDONED };
+
+//Replay parsed from archive, actions point to archive data
+struct Replay
+{
+	int version, mode, result;
+	int width, height, mines;
+	uint64_t seed;
+	uint32_t gameTime;
+	uint32_t actionCount;
+	const uint8_t* actions;
+	const uint8_t* actionsEnd;
+};
+
+//Records game actions into compact binary replay
+//Every action is one varint (tile index * 8 + action) followed by varint of milliseconds since previous action
+//Actions are written to preallocated buffer, replay is appended to archive file only when game ends
+//Archive starts with header, followed by replays each prefixed by its size (varint):
+//	format version, mode, result (bytes), width, height, mines (varints), seed (8 bytes, little endian),
+//	game time in milliseconds, action count (varints), actions
+class ReplayRecorder
+{
+public:
+	static const uint32_t FORMAT_VERSION = 1;
+	static const size_t BUFFER_SIZE = 16384;
+
+	ReplayRecorder();
+
+	//Start recording new game, time is in milliseconds (any base)
+	void start(int mode, int width, int height, int mines, uint64_t seed, uint32_t time);
+
+	void addAction(ReplayAction action, uint32_t tile, uint32_t time)
+	{
+		if (!recording)
+		{
+			return;
+		}
+
+		writeVarint(actions, (uint64_t)tile * 8 + action);
+		writeVarint(actions, time - lastTime);
+
+		lastTime = time;
+		actionCount++;
+	}
+
+	//Stop recording and append replay to archive
+	//Before the first append to archive, replay cut by interrupted write is removed from its end
+	bool finish(const std::string& archivePath, ReplayResult result, uint32_t gameTime);
+
+	//Stop recording without storing replay
+	void discard() { recording = false; }
+
+	bool isRecording() const { return recording; }
+
+	static void writeVarint(std::vector<uint8_t>& buffer, uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			buffer.push_back((uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+
+		buffer.push_back((uint8_t)value);
+	}
+
+private:
+	static bool repairArchive(const std::string& archivePath);
+
+	bool recording;
+	int mode, width, height, mines;
+	uint64_t seed;
+	uint32_t lastTime;
+	uint32_t actionCount;
+	std::vector<uint8_t> actions;
+	std::vector<uint8_t> replay;
+	std::string repairedArchivePath;
+};
+
+//Reads replays from archive data without copying them
+namespace ReplayReader
+{
+	const size_t ARCHIVE_HEADER_SIZE = 4;
+
+	bool isArchive(const uint8_t* data, size_t size);
+
+	//Size of replay (including its size prefix) that starts at data, 0 if it doesn't fit in size
+	size_t getReplaySize(const uint8_t* data, size_t size);
+
+	//Parse complete replay returned by getReplaySize()
+	bool parseReplay(const uint8_t* data, size_t size, Replay& replay);
+
+	//Read next action, returns false at the end of actions or if they are damaged
+	bool readAction(const uint8_t*& data, const uint8_t* end, ReplayAction& action, uint32_t& tile, uint32_t& timeDelta);
+
+	bool readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value);
+}
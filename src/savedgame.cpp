@@ -0,0 +1,203 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "savedgame.h"
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#define SAVED_GAME_MAGIC 0x53445344 //"DSDS"
+#define SAVED_GAME_VERSION 2
+#define SAVED_GAME_BAND_ROWS CHUNK_SIZE //Rows processed by one job, whole chunks have to be in the same band
+#define SAVED_GAME_PRACTICE 0x01 //Flag of practice game
+
+enum SavedGamePlane { PLANE_MINES, PLANE_VISIBLE, PLANE_FLAGS, PLANE_UNKNOWN, PLANE_COUNT };
+
+struct SavedGameHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t headerSize; //Planes start right after header
+	uint32_t width, height, mines;
+	uint32_t mode;
+	uint32_t gameTime;
+	uint32_t clickCount;
+	uint32_t rowWords;
+	uint32_t flags;
+	uint32_t reserved;
+	uint64_t seed;
+	uint64_t planeSize; //Bytes of one plane
+};
+
+static_assert(sizeof(SavedGameHeader) % 8 == 0, "Planes have to start at 64 bit boundary");
+
+static int countBits(uint64_t value)
+{
+	value = value - ((value >> 1) & 0x5555555555555555ull);
+	value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+
+	return (int)((value * 0x0101010101010101ull) >> 56);
+}
+
+bool saveGame(const std::string& path, const Minefield& minefield, const SavedGameInfo& info, ThreadPool* threadPool)
+{
+	SavedGameHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = SAVED_GAME_MAGIC;
+	header.version = SAVED_GAME_VERSION;
+	header.headerSize = sizeof(header);
+	header.width = minefield.getWidth();
+	header.height = minefield.getHeight();
+	header.mines = minefield.getMines();
+	header.mode = info.mode;
+	header.gameTime = info.gameTime;
+	header.clickCount = info.clickCount;
+	header.rowWords = minefield.getRowWords();
+	header.flags = info.practice ? SAVED_GAME_PRACTICE : 0;
+	header.seed = info.seed;
+
+	size_t planeWords = (size_t)header.rowWords * header.height;
+	header.planeSize = planeWords * sizeof(uint64_t);
+
+	std::vector<uint64_t> planes(planeWords * PLANE_COUNT);
+
+	ThreadPool::forEachBand(threadPool, header.height, SAVED_GAME_BAND_ROWS, [&](int, int firstRow, int lastRow)
+	{
+		for (int row = firstRow; row < lastRow; row++)
+		{
+			size_t offset = (size_t)row * header.rowWords;
+
+			minefield.packRow(row, planes.data() + offset, planes.data() + planeWords + offset,
+				planes.data() + planeWords * 2 + offset, planes.data() + planeWords * 3 + offset);
+		}
+
+		//Paged field is read only once, so band doesn't need to stay in memory
+		minefield.releaseArea(firstRow, lastRow, 0, header.width);
+	});
+
+	//Write to temporary file first so interrupted write never leaves broken save
+	std::string temporaryPath = path + ".tmp";
+	FILE* file = fopen(temporaryPath.c_str(), "wb");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(planes.data(), sizeof(uint64_t), planes.size(), file) == planes.size();
+	written = (fclose(file) == 0) && written;
+
+	std::error_code errorCode;
+
+	if (written)
+	{
+		std::filesystem::rename(temporaryPath, path, errorCode);
+	}
+
+	if (!written || errorCode)
+	{
+		std::filesystem::remove(temporaryPath, errorCode);
+		return false;
+	}
+
+	return true;
+}
+
+bool loadGame(const std::string& path, Minefield& minefield, SavedGameInfo& info, ThreadPool* threadPool)
+{
+	MappedFile file;
+
+	if (!file.open(path) || file.getSize() < sizeof(SavedGameHeader))
+	{
+		return false;
+	}
+
+	SavedGameHeader header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	if (header.magic != SAVED_GAME_MAGIC || header.version != SAVED_GAME_VERSION || header.headerSize < sizeof(header) || header.headerSize % 8 != 0
+		|| header.width < 1 || header.width > MAX_FIELD_SIZE || header.height < 1 || header.height > MAX_FIELD_SIZE
+		|| header.mines < 1 || header.mines >= header.width * header.height || header.rowWords != (header.width + 63) / 64
+		|| header.planeSize != (uint64_t)header.rowWords * header.height * sizeof(uint64_t)
+		|| file.getSize() != header.headerSize + header.planeSize * PLANE_COUNT)
+	{
+		return false;
+	}
+
+	const uint64_t* planes[PLANE_COUNT];
+
+	for (int i = 0; i < PLANE_COUNT; i++)
+	{
+		planes[i] = (const uint64_t*)(file.getData() + header.headerSize + header.planeSize * i);
+	}
+
+	//Count state bits first so damaged file doesn't replace current field
+	//Bits past the last column are ignored
+	uint64_t lastWordMask = (header.width % 64 == 0) ? ~0ull : ((1ull << (header.width % 64)) - 1);
+	int64_t mineCount = 0, visibleCount = 0, flagCount = 0;
+
+	for (uint32_t row = 0; row < header.height; row++)
+	{
+		for (uint32_t word = 0; word < header.rowWords; word++)
+		{
+			size_t index = (size_t)row * header.rowWords + word;
+			uint64_t mask = (word == header.rowWords - 1) ? lastWordMask : ~0ull;
+
+			mineCount += countBits(planes[PLANE_MINES][index] & mask);
+			visibleCount += countBits(planes[PLANE_VISIBLE][index] & ~planes[PLANE_MINES][index] & mask);
+			flagCount += countBits(planes[PLANE_FLAGS][index] & mask);
+		}
+	}
+
+	if (mineCount != header.mines)
+	{
+		return false;
+	}
+
+	minefield.reset(header.width, header.height, header.mines);
+
+	ThreadPool::forEachBand(threadPool, header.height, SAVED_GAME_BAND_ROWS, [&](int, int firstRow, int lastRow)
+	{
+		for (int row = firstRow; row < lastRow; row++)
+		{
+			size_t offset = (size_t)row * header.rowWords;
+
+			minefield.unpackRow(row, planes[PLANE_MINES] + offset, planes[PLANE_VISIBLE] + offset,
+				planes[PLANE_FLAGS] + offset, planes[PLANE_UNKNOWN] + offset);
+		}
+	});
+
+	//Counts depend on neighbour rows, so they are computed after all rows are unpacked
+	ThreadPool::forEachBand(threadPool, header.height, SAVED_GAME_BAND_ROWS, [&minefield](int, int firstRow, int lastRow)
+	{
+		minefield.countMines(firstRow, lastRow);
+		minefield.releaseArea(firstRow, lastRow, 0, minefield.getWidth());
+	});
+
+	minefield.restoreCounters(visibleCount, header.mines - (int)flagCount);
+
+	info.mode = header.mode;
+	info.seed = header.seed;
+	info.gameTime = header.gameTime;
+	info.clickCount = header.clickCount;
+	info.practice = (header.flags & SAVED_GAME_PRACTICE) != 0;
+
+	return true;
+}
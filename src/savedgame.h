@@ -0,0 +1,38 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "minefield.h"
+#include "threadpool.h"
+
+//Game state stored together with the field
+struct SavedGameInfo
+{
+	int mode;
+	uint64_t seed;
+	uint32_t gameTime; //Milliseconds
+	int clickCount;
+	bool practice; //Undo was used, so game can't set records
+};
+
+//Saved game file - header followed by mine, visible, flag and unknown bitplanes
+//Planes are stored as 64 bit words (little endian), so they are used directly from memory mapped file without parsing
+//Mine counts aren't stored, they are computed from mine plane when game is loaded
+//Rows are processed in parallel bands when thread pool is given
+bool saveGame(const std::string& path, const Minefield& minefield, const SavedGameInfo& info, ThreadPool* threadPool);
+bool loadGame(const std::string& path, Minefield& minefield, SavedGameInfo& info, ThreadPool* threadPool);
@@ -0,0 +1,73 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "startupprofiler.h"
+
+StartupProfiler::StartupProfiler()
+{
+	startTime = std::chrono::steady_clock::now();
+	lastMark = 0.0;
+}
+
+double StartupProfiler::now() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void StartupProfiler::mark(const std::string& phase)
+{
+	double time = now();
+
+	std::lock_guard<std::mutex> lock(phasesMutex);
+	phases.push_back({ phase, lastMark, time, false });
+	lastMark = time;
+}
+
+void StartupProfiler::addBackgroundPhase(const std::string& phase, double start, double end)
+{
+	std::lock_guard<std::mutex> lock(phasesMutex);
+	phases.push_back({ phase, start, end, true });
+}
+
+void StartupProfiler::print(FILE* file, bool json) const
+{
+	std::lock_guard<std::mutex> lock(phasesMutex);
+
+	if (json)
+	{
+		fprintf(file, "{\"total_ms\": %.3f, \"phases\": [", lastMark);
+
+		for (size_t i = 0; i < phases.size(); i++)
+		{
+			fprintf(file, "%s\n  {\"name\": \"%s\", \"start_ms\": %.3f, \"duration_ms\": %.3f, \"background\": %s}", i > 0 ? "," : "",
+				phases[i].name.c_str(), phases[i].start, phases[i].end - phases[i].start, phases[i].background ? "true" : "false");
+		}
+
+		fprintf(file, "\n]}\n");
+
+		return;
+	}
+
+	fprintf(file, "%-28s %10s %10s %7s\n", "Startup phase", "start ms", "took ms", "share");
+
+	for (const Phase& phase : phases)
+	{
+		double duration = phase.end - phase.start;
+
+		fprintf(file, "%-28s %10.2f %10.2f %6.1f%%\n", (phase.background ? "  (worker) " + phase.name : phase.name).c_str(),
+			phase.start, duration, lastMark > 0.0 ? duration * 100.0 / lastMark : 0.0);
+	}
+
+	fprintf(file, "%-28s %10s %10.2f\n", "Total (until first frame)", "", lastMark);
+}
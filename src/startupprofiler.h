@@ -0,0 +1,56 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Records how long every startup phase takes
+//Phases on main thread follow each other, phase ends when next one is marked
+//Background phases run on worker threads and overlap with main thread ones
+class StartupProfiler
+{
+public:
+	StartupProfiler();
+
+	//Time in milliseconds since profiler was created
+	double now() const;
+
+	//End current main thread phase with given name and start next one
+	void mark(const std::string& phase);
+
+	//Add phase that was running on worker thread (can be called from any thread)
+	void addBackgroundPhase(const std::string& phase, double start, double end);
+
+	//Print table with all phases, or JSON object if json is set
+	void print(FILE* file, bool json) const;
+
+private:
+	struct Phase
+	{
+		std::string name;
+		double start;
+		double end;
+		bool background;
+	};
+
+	std::chrono::steady_clock::time_point startTime;
+	double lastMark;
+	std::vector<Phase> phases;
+	mutable std::mutex phasesMutex;
+};
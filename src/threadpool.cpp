@@ -0,0 +1,174 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(int threadCount)
+{
+	stopping = false;
+
+	if (threadCount <= 0)
+	{
+		threadCount = (int)std::thread::hardware_concurrency() - 1;
+	}
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(tasksMutex);
+		stopping = true;
+	}
+
+	tasksCondition.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::forEachBand(ThreadPool* threadPool, int rowCount, int bandRows, const std::function<void(int, int, int)>& job)
+{
+	int bandCount = (rowCount + bandRows - 1) / bandRows;
+
+	auto bandJob = [rowCount, bandRows, &job](int band)
+	{
+		job(band, band * bandRows, std::min(rowCount, (band + 1) * bandRows));
+	};
+
+	if (threadPool != NULL)
+	{
+		threadPool->parallelFor(bandCount, bandJob);
+	}
+	else
+	{
+		for (int band = 0; band < bandCount; band++)
+		{
+			bandJob(band);
+		}
+	}
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& job)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	//No workers or nothing to split - run everything on calling thread
+	if (workers.empty() || count == 1)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			job(i);
+		}
+
+		return;
+	}
+
+	//Shared state outlives this call, helpers that start late only find out there is nothing left
+	struct ParallelForState
+	{
+		std::function<void(int)> job;
+		std::atomic<int> nextIndex;
+		std::atomic<int> doneCount;
+		int count;
+		std::mutex doneMutex;
+		std::condition_variable doneCondition;
+	};
+
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->job = job;
+	state->nextIndex = 0;
+	state->doneCount = 0;
+	state->count = count;
+
+	auto runJobs = [](ParallelForState& s)
+	{
+		int index;
+
+		while ((index = s.nextIndex.fetch_add(1)) < s.count)
+		{
+			s.job(index);
+
+			if (s.doneCount.fetch_add(1) + 1 == s.count)
+			{
+				std::lock_guard<std::mutex> lock(s.doneMutex);
+				s.doneCondition.notify_all();
+			}
+		}
+	};
+
+	int helperCount = std::min(count - 1, (int)workers.size());
+
+	for (int i = 0; i < helperCount; i++)
+	{
+		enqueue([state, runJobs]() { runJobs(*state); });
+	}
+
+	runJobs(*state);
+
+	std::unique_lock<std::mutex> lock(state->doneMutex);
+	state->doneCondition.wait(lock, [&state]() { return state->doneCount == state->count; });
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+	//Without workers task would never run - run it on calling thread
+	if (workers.empty())
+	{
+		task();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(tasksMutex);
+		tasks.push_back(std::move(task));
+	}
+
+	tasksCondition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(tasksMutex);
+			tasksCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+			if (stopping && tasks.empty())
+			{
+				return;
+			}
+
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,70 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed size pool of worker threads
+class ThreadPool
+{
+public:
+	//Thread count 0 means one worker for every hardware thread except calling one
+	explicit ThreadPool(int threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//Number of worker threads (calling thread is not counted)
+	int getThreadCount() const { return (int)workers.size(); }
+
+	//Run job for every index in [0, count) and wait until all of them are done
+	//Calling thread takes part in the work so it's safe to call it from pool tasks
+	void parallelFor(int count, const std::function<void(int)>& job);
+
+	//Split rowCount rows into bands of bandRows rows and run job with index, first row and end row of every band
+	//Without pool (threadPool is NULL) bands are run one after another on calling thread
+	static void forEachBand(ThreadPool* threadPool, int rowCount, int bandRows, const std::function<void(int band, int firstRow, int lastRow)>& job);
+
+	//Run task on worker thread, result can be obtained from returned future
+	//If pool has no workers task is run before returning
+	template<typename Task>
+	auto submit(Task task) -> std::future<decltype(task())>
+	{
+		auto packagedTask = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+		std::future<decltype(task())> result = packagedTask->get_future();
+
+		enqueue([packagedTask]() { (*packagedTask)(); });
+
+		return result;
+	}
+
+private:
+	void enqueue(std::function<void()> task);
+	void workerLoop();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex tasksMutex;
+	std::condition_variable tasksCondition;
+	bool stopping;
+};
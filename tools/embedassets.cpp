@@ -0,0 +1,96 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//Build time tool decoding PNG assets into header with raw RGBA pixel arrays
+//Usage: embedassets output.h name=image.png [name=image.png ...]
+//Every image is stored as EmbeddedImage called embeddedName (for example tiles=tiles.png gives embeddedTiles)
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb/stb_image.h"
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s output.h name=image.png [name=image.png ...]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	FILE* output = fopen(argv[1], "w");
+
+	if (output == NULL)
+	{
+		fprintf(stderr, "Can't create %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	fprintf(output, "//Generated by embedassets - do not edit\n\n");
+	fprintf(output, "#pragma once\n\n");
+	fprintf(output, "struct EmbeddedImage\n{\n\tconst unsigned char* pixels; //RGBA, 4 bytes per pixel\n\tint width;\n\tint height;\n};\n");
+
+	for (int i = 2; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		size_t separator = argument.find('=');
+
+		if (separator == std::string::npos)
+		{
+			fprintf(stderr, "Invalid argument %s\n", argv[i]);
+			fclose(output);
+			return EXIT_FAILURE;
+		}
+
+		std::string name = argument.substr(0, separator);
+		std::string path = argument.substr(separator + 1);
+
+		if (name.empty())
+		{
+			fprintf(stderr, "Missing name in argument %s\n", argv[i]);
+			fclose(output);
+			return EXIT_FAILURE;
+		}
+
+		name[0] = toupper(name[0]);
+
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+
+		if (pixels == NULL)
+		{
+			fprintf(stderr, "Failed loading %s: %s\n", path.c_str(), stbi_failure_reason());
+			fclose(output);
+			return EXIT_FAILURE;
+		}
+
+		fprintf(output, "\n//%s\nstatic const unsigned char embedded%sPixels[] =\n{", path.c_str(), name.c_str());
+
+		for (int p = 0; p < width * height * 4; p++)
+		{
+			fprintf(output, "%s0x%02x,", (p % 16 == 0) ? "\n\t" : " ", pixels[p]);
+		}
+
+		fprintf(output, "\n};\n\nstatic const EmbeddedImage embedded%s = { embedded%sPixels, %d, %d };\n", name.c_str(), name.c_str(), width, height);
+
+		stbi_image_free(pixels);
+	}
+
+	fclose(output);
+
+	return EXIT_SUCCESS;
+}
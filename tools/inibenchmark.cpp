@@ -0,0 +1,117 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//Benchmark of config loading
+//Usage: inibenchmark [sections] [keys per section] [iterations]
+//Generates config with given number of entries (similar to per board size best times) and measures how long it takes to load it
+//with stream read (mINI::INIFile::read) and with memory mapped file tokenized in place (as dsdmine does)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+#include "mini/ini.h"
+#include "mappedfile.h"
+
+//Run test iterations times, return fastest run in milliseconds
+template <typename Test>
+double measure(int iterations, Test test)
+{
+	double best = 0.0;
+
+	for (int i = 0; i < iterations; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		if (!test())
+		{
+			return -1.0;
+		}
+
+		double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (i == 0 || time < best)
+		{
+			best = time;
+		}
+	}
+
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	int sectionCount = (argc > 1) ? atoi(argv[1]) : 1000;
+	int keyCount = (argc > 2) ? atoi(argv[2]) : 10;
+	int iterations = (argc > 3) ? atoi(argv[3]) : 20;
+
+	if (sectionCount < 1 || keyCount < 1 || iterations < 1)
+	{
+		fprintf(stderr, "Usage: %s [sections] [keys per section] [iterations]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::string path = (std::filesystem::temp_directory_path() / "inibenchmark.ini").string();
+
+	//Sections look like custom board leaderboards, keys like their entries
+	mINI::INIStructure generated;
+
+	for (int section = 0; section < sectionCount; section++)
+	{
+		std::string sectionName = "Custom " + std::to_string(9 + section % 100) + "x" + std::to_string(9 + section / 100) + " " + std::to_string(10 + section);
+
+		for (int key = 0; key < keyCount; key++)
+		{
+			generated[sectionName]["Entry" + std::to_string(key)] = "Player" + std::to_string(key) + " " + std::to_string(100 + key * 7);
+		}
+	}
+
+	if (!mINI::INIFile(path).generate(generated, true))
+	{
+		fprintf(stderr, "Can't create %s\n", path.c_str());
+		return EXIT_FAILURE;
+	}
+
+	double streamTime = measure(iterations, [&path]()
+	{
+		mINI::INIStructure data;
+		return mINI::INIFile(path).read(data);
+	});
+
+	double mappedTime = measure(iterations, [&path]()
+	{
+		MappedFile file;
+
+		if (!file.open(path))
+		{
+			return false;
+		}
+
+		mINI::INIStructure data;
+		mINI::INIReader reader(mINI::INIReader::inMemory);
+		return reader.parse(std::string_view((const char*)file.getData(), file.getSize()), data);
+	});
+
+	printf("Entries: %d (%d sections), file size: %llu bytes, best of %d runs\n", sectionCount * keyCount, sectionCount,
+		(unsigned long long)std::filesystem::file_size(path), iterations);
+	printf("Stream read: %.3f ms\n", streamTime);
+	printf("Memory mapped: %.3f ms\n", mappedTime);
+
+	std::error_code errorCode;
+	std::filesystem::remove(path, errorCode);
+
+	return (streamTime < 0.0 || mappedTime < 0.0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
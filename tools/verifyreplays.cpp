@@ -0,0 +1,283 @@
+/*
+Copyright 2023 DragonSWDev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//Replay verifier - re-plays every game from replay archive with game rules and checks that recorded result and time match
+//Usage: verifyreplays replays.bin [--verbose]
+//Archive is read in blocks and replays from every block are verified in parallel
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "minefield.h"
+#include "replay.h"
+#include "threadpool.h"
+
+#define READ_BLOCK_SIZE (8 * 1024 * 1024)
+#define REPLAYS_PER_JOB 256
+
+enum VerifyResult { VERIFY_OK, VERIFY_DAMAGED, VERIFY_INVALID_BOARD, VERIFY_INVALID_ACTION, VERIFY_WRONG_RESULT, VERIFY_WRONG_TIME, VERIFY_RESULT_COUNT };
+
+const char* verifyResultNames[VERIFY_RESULT_COUNT] = { "Valid", "Damaged", "Invalid board", "Invalid action", "Wrong result", "Wrong time" };
+
+//Play replay on the field and compare outcome with recorded one
+VerifyResult verifyReplay(const uint8_t* data, size_t size, Minefield& minefield)
+{
+	Replay replay;
+
+	if (!ReplayReader::parseReplay(data, size, replay) || replay.version != (int)ReplayRecorder::FORMAT_VERSION)
+	{
+		return VERIFY_DAMAGED;
+	}
+
+	if (replay.width < 1 || replay.width > MAX_FIELD_SIZE || replay.height < 1 || replay.height > MAX_FIELD_SIZE
+		|| replay.mines < 1 || replay.mines >= replay.width * replay.height)
+	{
+		return VERIFY_INVALID_BOARD;
+	}
+
+	minefield.reset(replay.width, replay.height, replay.mines);
+
+	const uint8_t* position = replay.actions;
+	bool generated = false, finished = false, restarted = false;
+	int result = REPLAY_ABANDONED;
+	uint64_t time = 0, startTime = 0;
+	uint32_t actionCount = 0;
+
+	ReplayAction action;
+	uint32_t tile, timeDelta;
+
+	while (position < replay.actionsEnd)
+	{
+		if (!ReplayReader::readAction(position, replay.actionsEnd, action, tile, timeDelta))
+		{
+			return VERIFY_DAMAGED;
+		}
+
+		time += timeDelta;
+		actionCount++;
+
+		//Nothing can happen after game ended
+		if (finished || restarted)
+		{
+			return VERIFY_INVALID_ACTION;
+		}
+
+		if (action == ACTION_RESTART)
+		{
+			restarted = true;
+			continue;
+		}
+
+		if (tile >= (uint32_t)(replay.width * replay.height))
+		{
+			return VERIFY_INVALID_ACTION;
+		}
+
+		int row = tile / replay.width;
+		int column = tile % replay.width;
+
+		if (action == ACTION_REVEAL)
+		{
+			if (!minefield.isSelectable(row, column))
+			{
+				return VERIFY_INVALID_ACTION;
+			}
+
+			//Field is generated on first reveal and timer starts
+			if (!generated)
+			{
+				minefield.generate(replay.seed, row, column);
+				generated = true;
+				startTime = time;
+			}
+
+			if (!minefield.uncover(row, column))
+			{
+				result = REPLAY_LOST;
+				finished = true;
+			}
+			else if (minefield.isCleared())
+			{
+				result = REPLAY_WON;
+				finished = true;
+			}
+
+			continue;
+		}
+
+		//Marks cycle through flag, question mark (if enabled) and nothing
+		FieldType state = minefield.getTile(row, column);
+		ReplayAction expected = (state & FIELD_UNKNOWN) ? ACTION_CLEAR : (state & FIELD_FLAG) ? action : ACTION_FLAG;
+
+		if ((state & FIELD_VISIBLE) || action != expected || (action == ACTION_FLAG && (state & FIELD_FLAG)))
+		{
+			return VERIFY_INVALID_ACTION;
+		}
+
+		minefield.mark(row, column, action == ACTION_UNKNOWN);
+	}
+
+	if (actionCount != replay.actionCount)
+	{
+		return VERIFY_DAMAGED;
+	}
+
+	if (!generated || result != replay.result)
+	{
+		return VERIFY_WRONG_RESULT;
+	}
+
+	//Finished game ends with its last reveal, abandoned one can't end before its last action
+	uint64_t playTime = time - startTime;
+
+	if ((finished && replay.gameTime != playTime) || (!finished && replay.gameTime < playTime))
+	{
+		return VERIFY_WRONG_TIME;
+	}
+
+	return VERIFY_OK;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s replays.bin [--verbose]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	bool verbose = (argc > 2 && strcmp(argv[2], "--verbose") == 0);
+
+	FILE* archive = fopen(argv[1], "rb");
+
+	if (archive == NULL)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	ThreadPool threadPool;
+	std::vector<uint8_t> buffer(READ_BLOCK_SIZE);
+	size_t bufferedSize = fread(buffer.data(), 1, buffer.size(), archive);
+
+	if (!ReplayReader::isArchive(buffer.data(), bufferedSize))
+	{
+		fprintf(stderr, "%s is not replay archive\n", argv[1]);
+		fclose(archive);
+		return EXIT_FAILURE;
+	}
+
+	size_t offset = ReplayReader::ARCHIVE_HEADER_SIZE;
+	uint64_t replayIndex = 0, totalBytes = 0;
+	uint64_t counts[VERIFY_RESULT_COUNT] = {};
+	bool incomplete = false;
+
+	std::vector<size_t> replayOffsets;
+	std::vector<uint8_t> results;
+
+	for (;;)
+	{
+		//Split buffered data into complete replays
+		replayOffsets.clear();
+
+		for (;;)
+		{
+			size_t replaySize = ReplayReader::getReplaySize(buffer.data() + offset, bufferedSize - offset);
+
+			if (replaySize == 0)
+			{
+				break;
+			}
+
+			replayOffsets.push_back(offset);
+			offset += replaySize;
+		}
+
+		replayOffsets.push_back(offset);
+
+		int replayCount = (int)replayOffsets.size() - 1;
+		results.resize(replayCount);
+
+		threadPool.parallelFor((replayCount + REPLAYS_PER_JOB - 1) / REPLAYS_PER_JOB, [&](int job)
+		{
+			thread_local Minefield minefield;
+			int end = std::min(replayCount, (job + 1) * REPLAYS_PER_JOB);
+
+			for (int i = job * REPLAYS_PER_JOB; i < end; i++)
+			{
+				results[i] = verifyReplay(buffer.data() + replayOffsets[i], replayOffsets[i + 1] - replayOffsets[i], minefield);
+			}
+		});
+
+		for (int i = 0; i < replayCount; i++)
+		{
+			counts[results[i]]++;
+
+			if (verbose && results[i] != VERIFY_OK)
+			{
+				printf("Replay %llu: %s\n", (unsigned long long)(replayIndex + i), verifyResultNames[results[i]]);
+			}
+		}
+
+		replayIndex += replayCount;
+		totalBytes += offset;
+
+		//Move incomplete replay to the start and read next block after it
+		size_t remaining = bufferedSize - offset;
+		memmove(buffer.data(), buffer.data() + offset, remaining);
+
+		//Replay bigger than buffer needs bigger buffer
+		if (remaining == buffer.size())
+		{
+			buffer.resize(buffer.size() * 2);
+		}
+
+		size_t readSize = fread(buffer.data() + remaining, 1, buffer.size() - remaining, archive);
+		bufferedSize = remaining + readSize;
+		offset = 0;
+
+		if (readSize == 0)
+		{
+			incomplete = (remaining > 0);
+			totalBytes += remaining;
+			break;
+		}
+	}
+
+	fclose(archive);
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("Replays: %llu (%.1f MB) in %.3f s, %.0f replays/s, %d threads\n", (unsigned long long)replayIndex, totalBytes / (1024.0 * 1024.0),
+		seconds, replayIndex / seconds, threadPool.getThreadCount() + 1);
+
+	for (int i = 0; i < VERIFY_RESULT_COUNT; i++)
+	{
+		printf("%s: %llu\n", verifyResultNames[i], (unsigned long long)counts[i]);
+	}
+
+	if (incomplete)
+	{
+		printf("Archive ends with incomplete replay\n");
+	}
+
+	return (counts[VERIFY_OK] == replayIndex && !incomplete) ? EXIT_SUCCESS : EXIT_FAILURE;
+}